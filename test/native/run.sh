@@ -0,0 +1,18 @@
+#!/bin/sh
+# Builds and runs the host tests once for each platform: sh test/native/run.sh
+# Needs only g++. Every test_*.cpp is a standalone program that includes the WLED sources it tests
+cd "$(dirname "$0")"
+build=$(mktemp -d)
+failed=0
+for t in test_*.cpp; do
+  for arch in ESP8266 ARDUINO_ARCH_ESP32; do
+    bin="$build/${t%.cpp}_$arch"
+    if ! g++ -std=gnu++11 -O1 -Wall -Wno-unused-variable -D$arch -I stubs -I ../../wled00 -o "$bin" "$t" stubs/host.cpp; then
+      echo "$t ($arch): build failed"; failed=1; continue
+    fi
+    printf "%s " "$arch"
+    "$bin" || failed=1
+  done
+done
+rm -rf "$build"
+exit $failed
@@ -0,0 +1,54 @@
+#ifndef WLED_TEST_ARDUINO_H
+#define WLED_TEST_ARDUINO_H
+
+/*
+ * Minimal Arduino core for compiling WLED headers on the host, see test/native/run.sh
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+typedef uint8_t byte;
+
+#define F(s) (s)
+#define PSTR(s) (s)
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define INPUT 0
+#define INPUT_PULLUP 2
+
+//host time, advanced by the tests
+extern uint32_t hostMillis;
+extern uint32_t hostMicros;
+inline uint32_t millis() { return hostMillis; }
+inline uint32_t micros() { return hostMicros; }
+inline void yield() {}
+inline void delay(uint32_t ms) { hostMillis += ms; hostMicros += ms * 1000; }
+inline void delayMicroseconds(uint32_t us) { hostMicros += us; }
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline void analogWrite(uint8_t, int) {}
+inline void analogWriteRange(uint32_t) {}
+inline void analogWriteFreq(uint32_t) {}
+inline void ledcSetup(uint8_t, double, uint8_t) {}
+inline void ledcAttachPin(uint8_t, uint8_t) {}
+inline void ledcDetachPin(uint8_t) {}
+inline void ledcWrite(uint8_t, uint32_t) {}
+using std::min;
+using std::max;
+
+struct HostEsp {
+  uint32_t freeHeap = 40000;
+  uint32_t getFreeHeap() { return freeHeap; }
+};
+extern HostEsp ESP;
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef WLED_TEST_NEOPIXELBUS_H
+#define WLED_TEST_NEOPIXELBUS_H
+
+/*
+ * Stand-in for NeoPixelBus on the host: every feature/method combination is the same
+ * in-memory bus, so code that depends on the driver type (bus_wrapper.h) compiles unchanged
+ */
+
+#include <Arduino.h>
+
+struct RgbColor {
+  uint8_t R = 0, G = 0, B = 0;
+  RgbColor() {}
+  RgbColor(uint8_t r, uint8_t g, uint8_t b) : R(r), G(g), B(b) {}
+};
+
+struct RgbwColor {
+  uint8_t R = 0, G = 0, B = 0, W = 0;
+  RgbwColor() {}
+  RgbwColor(uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0) : R(r), G(g), B(b), W(w) {}
+  RgbwColor(const RgbColor& c) : R(c.R), G(c.G), B(c.B) {}
+};
+
+template<class T_COLOR_FEATURE, class T_METHOD> class NeoPixelBrightnessBus {
+  public:
+  NeoPixelBrightnessBus(uint16_t count, uint8_t = 0, uint8_t = 0) : _count(count) { _pixels = new RgbwColor[count]; }
+  ~NeoPixelBrightnessBus() { delete[] _pixels; }
+  void Begin() {}
+  void Begin(int8_t, int8_t, int8_t, int8_t) {}
+  void Show() { _shows++; }
+  bool CanShow() const { return true; }
+  void SetBrightness(uint8_t b) { _brightness = b; }
+  void SetPixelColor(uint16_t i, const RgbwColor& c) { if (i < _count) _pixels[i] = c; }
+  RgbwColor GetPixelColor(uint16_t i) const { return (i < _count) ? _pixels[i] : RgbwColor(); }
+  size_t PixelsSize() const { return _count * T_COLOR_FEATURE::PixelSize; }
+  uint16_t PixelCount() const { return _count; }
+  uint32_t _shows = 0;
+  private:
+  uint16_t _count;
+  uint8_t _brightness = 255;
+  RgbwColor* _pixels;
+};
+
+#define WLED_TEST_FEATURE(name, size) struct name { static const size_t PixelSize = size; };
+WLED_TEST_FEATURE(NeoGrbFeature, 3)
+WLED_TEST_FEATURE(NeoRbgFeature, 3)
+WLED_TEST_FEATURE(NeoGrbwFeature, 4)
+WLED_TEST_FEATURE(NeoWrgbTm1814Feature, 4)
+WLED_TEST_FEATURE(DotStarBgrFeature, 4)
+WLED_TEST_FEATURE(Lpd8806GrbFeature, 3)
+WLED_TEST_FEATURE(P9813BgrFeature, 4)
+
+#define WLED_TEST_METHOD(name) struct name {};
+//ESP8266
+WLED_TEST_METHOD(NeoEsp8266Uart0Ws2813Method) WLED_TEST_METHOD(NeoEsp8266Uart1Ws2813Method)
+WLED_TEST_METHOD(NeoEsp8266Dma800KbpsMethod) WLED_TEST_METHOD(NeoEsp8266BitBang800KbpsMethod)
+WLED_TEST_METHOD(NeoEsp8266Uart0400KbpsMethod) WLED_TEST_METHOD(NeoEsp8266Uart1400KbpsMethod)
+WLED_TEST_METHOD(NeoEsp8266Dma400KbpsMethod) WLED_TEST_METHOD(NeoEsp8266BitBang400KbpsMethod)
+WLED_TEST_METHOD(NeoEsp8266Uart0Tm1814Method) WLED_TEST_METHOD(NeoEsp8266Uart1Tm1814Method)
+WLED_TEST_METHOD(NeoEsp8266DmaTm1814Method) WLED_TEST_METHOD(NeoEsp8266BitBangTm1814Method)
+//ESP32
+WLED_TEST_METHOD(NeoEsp32Rmt0Ws2812xMethod) WLED_TEST_METHOD(NeoEsp32Rmt1Ws2812xMethod)
+WLED_TEST_METHOD(NeoEsp32Rmt2Ws2812xMethod) WLED_TEST_METHOD(NeoEsp32Rmt3Ws2812xMethod)
+WLED_TEST_METHOD(NeoEsp32Rmt4Ws2812xMethod) WLED_TEST_METHOD(NeoEsp32Rmt5Ws2812xMethod)
+WLED_TEST_METHOD(NeoEsp32Rmt6Ws2812xMethod) WLED_TEST_METHOD(NeoEsp32Rmt7Ws2812xMethod)
+WLED_TEST_METHOD(NeoEsp32I2s0800KbpsMethod) WLED_TEST_METHOD(NeoEsp32I2s1800KbpsMethod)
+WLED_TEST_METHOD(NeoEsp32Rmt0400KbpsMethod) WLED_TEST_METHOD(NeoEsp32Rmt1400KbpsMethod)
+WLED_TEST_METHOD(NeoEsp32Rmt2400KbpsMethod) WLED_TEST_METHOD(NeoEsp32Rmt3400KbpsMethod)
+WLED_TEST_METHOD(NeoEsp32Rmt4400KbpsMethod) WLED_TEST_METHOD(NeoEsp32Rmt5400KbpsMethod)
+WLED_TEST_METHOD(NeoEsp32Rmt6400KbpsMethod) WLED_TEST_METHOD(NeoEsp32Rmt7400KbpsMethod)
+WLED_TEST_METHOD(NeoEsp32I2s0400KbpsMethod) WLED_TEST_METHOD(NeoEsp32I2s1400KbpsMethod)
+WLED_TEST_METHOD(NeoEsp32Rmt0Tm1814Method) WLED_TEST_METHOD(NeoEsp32Rmt1Tm1814Method)
+WLED_TEST_METHOD(NeoEsp32Rmt2Tm1814Method) WLED_TEST_METHOD(NeoEsp32Rmt3Tm1814Method)
+WLED_TEST_METHOD(NeoEsp32Rmt4Tm1814Method) WLED_TEST_METHOD(NeoEsp32Rmt5Tm1814Method)
+WLED_TEST_METHOD(NeoEsp32Rmt6Tm1814Method) WLED_TEST_METHOD(NeoEsp32Rmt7Tm1814Method)
+WLED_TEST_METHOD(NeoEsp32I2s0Tm1814Method) WLED_TEST_METHOD(NeoEsp32I2s1Tm1814Method)
+//SPI chips
+WLED_TEST_METHOD(DotStarSpiMethod) WLED_TEST_METHOD(DotStarMethod)
+WLED_TEST_METHOD(Lpd8806SpiMethod) WLED_TEST_METHOD(Lpd8806Method)
+WLED_TEST_METHOD(NeoWs2801SpiMethod) WLED_TEST_METHOD(NeoWs2801Method)
+WLED_TEST_METHOD(P9813SpiMethod) WLED_TEST_METHOD(P9813Method)
+
+#endif
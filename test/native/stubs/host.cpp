@@ -0,0 +1,44 @@
+/*
+ * Definitions behind the host Arduino stubs
+ */
+
+#include <Arduino.h>
+#include "pin_manager.h"
+
+uint32_t hostMillis = 0;
+uint32_t hostMicros = 0;
+HostEsp ESP;
+PinManagerClass pinManager;
+
+void PinManagerClass::deallocatePin(byte gpio)
+{
+  if (!isPinOk(gpio, false)) return;
+  pinAlloc[gpio >> 3] &= ~(1 << (gpio & 7));
+}
+
+bool PinManagerClass::allocatePin(byte gpio, bool output)
+{
+  if (!isPinOk(gpio, output) || isPinAllocated(gpio)) return false;
+  pinAlloc[gpio >> 3] |= 1 << (gpio & 7);
+  return true;
+}
+
+bool PinManagerClass::isPinAllocated(byte gpio)
+{
+  if (!isPinOk(gpio, false)) return true;
+  return pinAlloc[gpio >> 3] & (1 << (gpio & 7));
+}
+
+bool PinManagerClass::isPinOk(byte gpio, bool output)
+{
+  return gpio < sizeof(pinAlloc) * 8;
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+byte PinManagerClass::allocateLedc(byte channels)
+{
+  return 0;
+}
+
+void PinManagerClass::deallocateLedc(byte pos, byte channels) {}
+#endif
@@ -0,0 +1,17 @@
+#ifndef WLED_TEST_H
+#define WLED_TEST_H
+
+/*
+ * Minimal checks for the host tests, a test binary exits with the number of failed checks
+ */
+
+#include <stdio.h>
+
+static int testFailures = 0;
+
+#define CHECK(cond) do { if (!(cond)) { testFailures++; printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); } } while (0)
+#define CHECK_EQ(a, b) do { long _a = (long)(a), _b = (long)(b); if (_a != _b) { testFailures++; printf("%s:%d: %s == %ld, expected %ld\n", __FILE__, __LINE__, #a, _a, _b); } } while (0)
+
+#define TEST_RESULT() (printf("%s: %s\n", __FILE__, testFailures ? "FAILED" : "ok"), testFailures)
+
+#endif
@@ -0,0 +1,131 @@
+/*
+ * Host tests for splitting one LED range across several outputs (BusManager::splitLength/addSplit/planSplit)
+ */
+
+#include "test.h"
+#include "bus_manager.h"
+
+static void testSplitLength()
+{
+  //parts are contiguous, cover the range and differ by at most one LED, longer ones first
+  const uint16_t counts[] = {1, 7, 100, 301, 1000};
+  for (uint16_t count : counts) {
+    for (uint8_t n = 1; n <= 8; n++) {
+      uint32_t sum = 0;
+      for (uint8_t k = 0; k < n; k++) {
+        uint16_t len = BusManager::splitLength(count, n, k);
+        sum += len;
+        CHECK(len == count / n || len == count / n +1);
+        if (k) CHECK(len <= BusManager::splitLength(count, n, k -1));
+      }
+      CHECK_EQ(sum, count);
+    }
+  }
+  CHECK_EQ(BusManager::splitLength(10, 3, 0), 4);
+  CHECK_EQ(BusManager::splitLength(10, 3, 2), 3);
+}
+
+static void testAddSplit()
+{
+  BusManager mgr;
+  ESP.freeHeap = 100000;
+  mgr.resetAdmission(0);
+  uint8_t pins[5] = {3, 255, 255, 255, 255};
+  BusConfig bc(TYPE_WS2812_RGB, pins, 10, 101);
+  #ifdef ESP8266
+  const uint8_t splitPins[] = {3, 2, 4};
+  #else
+  const uint8_t splitPins[] = {16, 17, 18};
+  #endif
+  CHECK_EQ(mgr.addSplit(bc, splitPins, 3, 1), 3);
+  CHECK_EQ(mgr.getNumBusses(), 3);
+  uint16_t start = 10;
+  for (uint8_t k = 0; k < 3; k++) {
+    Bus* part = mgr.getBus(k);
+    uint8_t partPins[5];
+    part->getPins(partPins);
+    CHECK_EQ(part->getStart(), start);
+    CHECK_EQ(part->getLength(), BusManager::splitLength(101, 3, k));
+    CHECK_EQ(partPins[0], splitPins[k]);
+    CHECK_EQ(part->splitGroup, 1);
+    start += part->getLength();
+  }
+  CHECK_EQ(start, 111);
+  mgr.removeAll();
+
+  //reversed ranges are fed from the other end, so the pins are assigned back to front
+  bc.reversed = true;
+  mgr.resetAdmission(0);
+  mgr.addSplit(bc, splitPins, 3, 1);
+  uint8_t partPins[5];
+  mgr.getBus(0)->getPins(partPins);
+  CHECK_EQ(partPins[0], splitPins[2]);
+  mgr.removeAll();
+
+  //not more parts than LEDs, and types that cannot be split stay one bus
+  BusConfig tiny(TYPE_WS2812_RGB, pins, 0, 2);
+  mgr.resetAdmission(0);
+  CHECK_EQ(mgr.addSplit(tiny, splitPins, 3, 1), 2);
+  mgr.removeAll();
+  uint8_t pwmPins[5] = {5, 255, 255, 255, 255};
+  BusConfig pwm(TYPE_ANALOG_1CH, pwmPins, 0, 1);
+  mgr.resetAdmission(0);
+  CHECK_EQ(mgr.addSplit(pwm, splitPins, 3, 1), 1);
+  CHECK_EQ(mgr.getBus(0)->splitGroup, 0);
+  mgr.removeAll();
+}
+
+static void testPlanSplit()
+{
+  //300 WS2812 LEDs take 300 * 24 * 1.25us + 50us latch on the wire
+  #ifdef ESP8266
+  uint8_t dma[] = {3};
+  CHECK_EQ(BusManager::planSplit(TYPE_WS2812_RGB, 300, dma, 1, 0), 1000000 / 9050);
+  //UART and bit-bang block while sending, so the parts add up
+  uint8_t pins[] = {2, 4};
+  CHECK_EQ(BusManager::planSplit(TYPE_WS2812_RGB, 300, pins, 2, 0), 1000000 / (2 * 4550));
+  //the DMA part sends while the others are written
+  uint8_t mixed[] = {3, 2, 4};
+  CHECK_EQ(BusManager::planSplit(TYPE_WS2812_RGB, 300, mixed, 3, 0), 1000000 / (3 * 3050));
+  #else
+  uint8_t pins[10] = {16, 17, 18, 19, 21, 22, 23, 25, 26, 27};
+  CHECK_EQ(BusManager::planSplit(TYPE_WS2812_RGB, 300, pins, 1, 0), 1000000 / 9050);
+  //RMT channels send in parallel, the longest part determines the frame time
+  CHECK_EQ(BusManager::planSplit(TYPE_WS2812_RGB, 300, pins, 4, 0), 1000000 / 2300);
+  CHECK_EQ(BusManager::planSplit(TYPE_WS2812_RGB, 301, pins, 4, 0), 1000000 / (76 * 30 + 50));
+  //there are only 10 channels
+  CHECK_EQ(BusManager::planSplit(TYPE_WS2812_RGB, 300, pins, 4, 7), 0);
+  #endif
+  CHECK_EQ(BusManager::planSplit(TYPE_WS2812_RGB, 0, pins, 1, 0), 0);
+  CHECK_EQ(BusManager::planSplit(TYPE_WS2812_RGB, 300, pins, 0, 0), 0);
+}
+
+static void testPlanFreePins()
+{
+  uint8_t pins[WLED_MAX_BUSSES] = {3};
+  #ifdef ESP8266
+  //the DMA pin is in use, the free hardware driven pins come before bit-banged ones
+  uint8_t taken[] = {3};
+  BusManager::planFreePins(pins, 1, 3, taken, 1);
+  CHECK_EQ(pins[1], 2);
+  CHECK_EQ(pins[2], 1);
+  uint8_t takenAll[] = {3, 1, 2};
+  BusManager::planFreePins(pins, 1, 3, takenAll, 3);
+  CHECK_EQ(pins[1], 255);
+  CHECK_EQ(pins[2], 255);
+  CHECK_EQ(PolyBus::getI(TYPE_WS2812_RGB, &pins[1], 1), I_8266_BB_NEO_3);
+  #else
+  uint8_t taken[] = {3};
+  BusManager::planFreePins(pins, 1, 4, taken, 1);
+  CHECK_EQ(pins[3], 3);
+  #endif
+}
+
+int main()
+{
+  testSplitLength();
+  testAddSplit();
+  testPlanSplit();
+  testPlanFreePins();
+  return TEST_RESULT();
+}
@@ -0,0 +1,139 @@
+/*
+ * Host tests for holding DDP frames with timecode (DdpFrameHold): the held frame must stay intact until it is shown
+ */
+
+#include "test.h"
+#include "ddp_hold.h"
+
+#define LEDS 8
+
+static byte pixels[LEDS * 3];   //the strip pixel buffer
+static byte shown[LEDS * 3];    //what the last show sent out
+static DdpFrameHold hold;
+static bool newData = false;    //e131NewData
+
+static void show()
+{
+  memcpy(shown, pixels, sizeof(pixels));
+  newData = false;
+}
+
+//what e131.cpp does after the held frame was shown or dropped
+static void writeHeld()
+{
+  uint16_t start, count;
+  const byte* data;
+  while ((data = hold.take(start, count))) memcpy(pixels + start * 3, data, count * hold.bpp());
+  if (hold.done(hostMillis)) newData = true;
+}
+
+//one DDP packet, the frame is filled with value v
+static void packet(uint16_t start, uint16_t count, byte v, bool push, uint32_t wait)
+{
+  byte data[LEDS * 3];
+  memset(data, v, sizeof(data));
+  if (hold.skip()) writeHeld();
+  if (hold.write(start, data, count, 3)) memcpy(pixels + start * 3, data, count * 3);
+  if (push && hold.push(hostMillis, wait)) newData = true;
+}
+
+//loop(): shows the held frame once it is due, then frames shown right away
+static void loop()
+{
+  if (hold.due(hostMillis)) {
+    show();
+    writeHeld();
+  }
+  if (newData) show();
+}
+
+static bool filled(const byte* buf, byte v)
+{
+  for (uint16_t i = 0; i < LEDS * 3; i++) if (buf[i] != v) return false;
+  return true;
+}
+
+static void testHeldFrameIntact()
+{
+  //frame 1 with timecode is held for 20ms, frame 2 arrives meanwhile in two packets
+  static byte copy[LEDS * 3];
+  hold.attach(copy, LEDS, 3);
+  hostMillis = 1000;
+  packet(0, LEDS, 1, true, 20);
+  loop();
+  CHECK(!filled(shown, 1)); //not due yet
+  hostMillis += 5;
+  packet(0, LEDS/2, 2, false, 0);
+  CHECK(filled(pixels, 1)); //the held frame is not overwritten
+  hostMillis += 5;
+  packet(LEDS/2, LEDS/2, 2, true, 20);
+  CHECK(filled(pixels, 1));
+  loop();
+  CHECK(!filled(shown, 1));
+
+  hostMillis = 1021;
+  loop();
+  CHECK(filled(shown, 1));   //frame 1 shown intact at its time
+  CHECK(filled(pixels, 2));  //frame 2 now waits in the pixel buffer
+  CHECK(!filled(shown, 2));
+  hostMillis = 1031;
+  loop();
+  CHECK(filled(shown, 2));
+  CHECK_EQ(hold.skipped, 0);
+
+  //without timecode frames are shown when they arrive
+  packet(0, LEDS, 3, true, 0);
+  loop();
+  CHECK(filled(shown, 3));
+}
+
+static void testIncompleteNextFrame()
+{
+  //the held frame is shown while the next one is still arriving, its remaining packets go to the pixel buffer directly
+  static byte copy[LEDS * 3];
+  hold.attach(copy, LEDS, 3);
+  hostMillis = 2000;
+  packet(0, LEDS, 4, true, 20);
+  packet(0, LEDS/2, 5, false, 0);
+  hostMillis = 2021;
+  loop();
+  CHECK(filled(shown, 4));
+  packet(LEDS/2, LEDS/2, 5, true, 0);
+  loop();
+  CHECK(filled(shown, 5));
+}
+
+static void testSenderAhead()
+{
+  //frame 3 starts while frame 1 is still held and frame 2 is complete: frame 1 is dropped, frame 2 is held instead
+  static byte copy[LEDS * 3];
+  hold.attach(copy, LEDS, 3);
+  hold.skipped = 0;
+  hostMillis = 3000;
+  packet(0, LEDS, 6, true, 20);
+  packet(0, LEDS, 7, true, 20);
+  packet(0, LEDS/2, 8, false, 0);
+  CHECK_EQ(hold.skipped, 1);
+  CHECK(filled(pixels, 7));
+  hostMillis = 3021;
+  loop();
+  CHECK(filled(shown, 7));
+  packet(LEDS/2, LEDS/2, 8, true, 0);
+  loop();
+  CHECK(filled(shown, 8));
+
+  //without the copy there is nothing to hold the next frame in, frames are shown when they arrive
+  bool held;
+  hold.detach(held);
+  packet(0, LEDS, 9, true, 20);
+  loop();
+  CHECK(filled(shown, 9));
+}
+
+int main()
+{
+  testHeldFrameIntact();
+  testIncompleteNextFrame();
+  testSenderAhead();
+  return TEST_RESULT();
+}
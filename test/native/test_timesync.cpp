@@ -0,0 +1,138 @@
+/*
+ * Host tests for the effect clock sync (TimeSync): nodes exchange their packets over a simulated network
+ */
+
+#include "test.h"
+#include "timesync.h"
+#include <vector>
+
+struct Node {
+  uint32_t ip;
+  uint32_t boot;      //millis() of this node = hostMillis - boot
+  uint32_t timebase = 0;
+  TimeSync ts;
+  Node(uint32_t nodeIp, uint32_t bootMs) : ip(nodeIp), boot(bootMs) {}
+  uint32_t clock() { return hostMillis - boot + timebase; }
+};
+
+struct Packet {
+  uint32_t due, from, to;
+  uint16_t len;
+  byte data[TIMESYNC_RESPONSE_LEN];
+};
+
+static std::vector<Packet> net;
+
+static void send(uint32_t from, uint32_t to, const byte* data, uint16_t len, uint32_t delay)
+{
+  Packet p;
+  p.due = hostMillis + delay; p.from = from; p.to = to; p.len = len;
+  memcpy(p.data, data, len);
+  net.push_back(p);
+}
+
+//runs the nodes for ms, packets take delay ms (one way)
+static void run(Node* nodes, uint8_t n, uint32_t ms, uint32_t delay, bool oldResponses = false)
+{
+  for (uint32_t end = hostMillis + ms; hostMillis != end; hostMillis++) {
+    for (uint8_t i = 0; i < n; i++) {
+      Node &nd = nodes[i];
+      nd.timebase += nd.ts.slew(hostMillis - nd.boot);
+      byte out[TIMESYNC_REQUEST_LEN];
+      if (nd.ts.request(hostMillis - nd.boot, nd.clock(), out)) send(nd.ip, nd.ts.ref, out, sizeof(out), delay);
+    }
+    for (size_t k = 0; k < net.size();) {
+      Packet p = net[k];
+      if (p.due != hostMillis) { k++; continue; }
+      net.erase(net.begin() + k);
+      for (uint8_t i = 0; i < n; i++) {
+        Node &nd = nodes[i];
+        if (nd.ip != p.to) continue;
+        if (p.data[1] == TIMESYNC_REQUEST) {
+          byte out[TIMESYNC_RESPONSE_LEN];
+          uint8_t len = nd.ts.respond(p.data, p.len, p.from, nd.clock(), out);
+          if (oldResponses && len) len--;
+          if (len) send(nd.ip, p.from, out, len, delay);
+        } else {
+          nd.timebase += nd.ts.receive(p.data, p.len, p.from, nd.ip, nd.clock());
+        }
+      }
+    }
+  }
+  net.clear();
+}
+
+static int32_t clockDiff(Node &a, Node &b)
+{
+  return (int32_t)(a.clock() - b.clock());
+}
+
+static void testFollow()
+{
+  //B follows A, the offset is slewed 1ms per TIMESYNC_SLEW_INTERVAL
+  Node nodes[2] = {{1, 0}, {2, 300}};
+  nodes[1].ts.setReference(1);
+  hostMillis = 1000;
+  CHECK_EQ(clockDiff(nodes[0], nodes[1]), 300);
+  run(nodes, 2, 5000, 3);
+  CHECK(nodes[1].ts.locked(1));
+  CHECK(!nodes[1].ts.locked(3));
+  CHECK_EQ(nodes[1].ts.offset + nodes[1].timebase, 300); //the part that was slewed already is no longer in the offset
+  CHECK_EQ(nodes[1].ts.rtt, 6);
+  run(nodes, 2, 40000, 3);
+  CHECK(abs(clockDiff(nodes[0], nodes[1])) <= 1);
+  CHECK(nodes[1].ts.error >= 0 && nodes[1].ts.error <= 4);
+  CHECK_EQ(nodes[0].timebase, 0); //the reference keeps its clock
+
+  //larger offsets are applied at once
+  nodes[1].timebase += 10000;
+  nodes[1].ts.reset();
+  run(nodes, 2, 3000, 3);
+  CHECK(abs(clockDiff(nodes[0], nodes[1])) <= 1);
+}
+
+static void testMutual()
+{
+  //two nodes notifying each other: the lower IP leads, the other one follows instead of both meeting halfway
+  Node nodes[2] = {{5, 0}, {9, 200}};
+  nodes[0].ts.setReference(9);
+  nodes[1].ts.setReference(5);
+  hostMillis = 1000;
+  run(nodes, 2, 45000, 2);
+  CHECK(nodes[0].ts.leading);
+  CHECK(!nodes[1].ts.leading);
+  CHECK_EQ(nodes[0].timebase, 0);
+  CHECK(abs(clockDiff(nodes[0], nodes[1])) <= 1);
+  CHECK(nodes[0].ts.locked(9)); //the leader ignores the coarse timebase of its follower
+  CHECK(nodes[1].ts.locked(5));
+
+  //once the follower picks another reference, the former leader syncs to it again
+  nodes[1].ts.setReference(7);
+  nodes[1].timebase += 100;
+  Node three[3] = {nodes[0], nodes[1], {7, 0}};
+  three[2].timebase = three[1].timebase;
+  run(three, 3, 30000, 2);
+  CHECK(!three[0].ts.leading);
+  CHECK(abs(clockDiff(three[0], three[1])) <= 1);
+}
+
+static void testOldResponder()
+{
+  //responses of older versions have no reference flag, both nodes follow each other as before
+  Node nodes[2] = {{5, 0}, {9, 0}};
+  nodes[0].ts.setReference(9);
+  nodes[1].ts.setReference(5);
+  hostMillis = 1000;
+  run(nodes, 2, 5000, 2, true);
+  CHECK(!nodes[0].ts.leading);
+  CHECK(!nodes[1].ts.leading);
+  CHECK(nodes[0].ts.locked(9));
+}
+
+int main()
+{
+  testFollow();
+  testMutual();
+  testOldResponder();
+  return TEST_RESULT();
+}
@@ -0,0 +1,199 @@
+/**
+ * Reference encoder for the compressed WLED realtime UDP protocol (DRLE, protocol byte 6)
+ *
+ * Packet: 0: 6, 1: timeout in s, 2: flags, 3: sequence number (+1 per packet), 4-5: start LED, 6-: ops
+ * flags: 0x01 keyframe, 0x02 RGBW, 0x04 last packet of the frame (show)
+ * Each op byte holds the type in bits 7-6 and the number of LEDs - 1 (1-64) in bits 5-0:
+ *   0 unchanged since the previous frame, 1 literal (n pixels follow), 2 run (1 pixel follows, repeated n times)
+ *
+ * How to use it?
+ *
+ * > node tools/drle.js bench [leds]                          compare bandwidth with DNRGB on a few effects
+ * > node tools/drle.js send <ip> [leds] [fps] [keyframe interval] [port]   stream a demo effect
+ *
+ * From another script: const { DrleEncoder } = require("./drle.js");
+ *   const enc = new DrleEncoder({ leds: 300 });
+ *   for (const packet of enc.encode(frame)) socket.send(packet, 21324, ip);
+ */
+
+const dgram = require("dgram");
+
+const HEADER_LEN = 6;
+const MAX_PACKET = 1472;
+const MAX_OP_LEN = 64;
+const FLAG_KEYFRAME = 0x01;
+const FLAG_RGBW = 0x02;
+const FLAG_PUSH = 0x04;
+const OP_SKIP = 0, OP_LITERAL = 1, OP_RUN = 2;
+
+class DrleEncoder {
+  /**
+   * leds: LED count, rgbw: 4 bytes per pixel, keyframeInterval: frames between keyframes,
+   * timeout: seconds WLED stays in realtime mode after the last packet
+   */
+  constructor({ leds, rgbw = false, keyframeInterval = 30, timeout = 2 }) {
+    this.leds = leds;
+    this.bpp = rgbw ? 4 : 3;
+    this.keyframeInterval = keyframeInterval;
+    this.timeout = timeout;
+    this.prev = null;
+    this.frameCount = 0;
+    this.seq = 0;
+  }
+
+  /** forces the next frame to be a keyframe, e.g. after the receiver restarted */
+  reset() {
+    this.prev = null;
+  }
+
+  same(a, i, b, j) {
+    for (let c = 0; c < this.bpp; c++) if (a[i * this.bpp + c] !== b[j * this.bpp + c]) return false;
+    return true;
+  }
+
+  /** splits a frame into ops [{type, n, data}] */
+  ops(frame, prev) {
+    const ops = [];
+    let i = 0;
+    while (i < this.leds) {
+      let n = 1;
+      if (prev && this.same(frame, i, prev, i)) {
+        while (i + n < this.leds && n < MAX_OP_LEN && this.same(frame, i + n, prev, i + n)) n++;
+        ops.push({ type: OP_SKIP, n });
+      } else if (i + 1 < this.leds && this.same(frame, i, frame, i + 1)) {
+        while (i + n < this.leds && n < MAX_OP_LEN && this.same(frame, i + n, frame, i)) n++;
+        ops.push({ type: OP_RUN, n, data: frame.subarray(i * this.bpp, (i + 1) * this.bpp) });
+      } else {
+        //literal until a pixel starts an unchanged span or a run
+        while (i + n < this.leds && n < MAX_OP_LEN) {
+          const j = i + n;
+          if (prev && this.same(frame, j, prev, j)) break;
+          if (j + 1 < this.leds && this.same(frame, j, frame, j + 1)) break;
+          n++;
+        }
+        ops.push({ type: OP_LITERAL, n, data: frame.subarray(i * this.bpp, (i + n) * this.bpp) });
+      }
+      i += n;
+    }
+    //trailing unchanged pixels need not be sent
+    while (ops.length > 1 && ops[ops.length - 1].type === OP_SKIP) ops.pop();
+    return ops;
+  }
+
+  /** encodes one frame (Uint8Array of leds * bpp bytes) into one or more UDP packets */
+  encode(frame) {
+    const key = !this.prev || this.frameCount % this.keyframeInterval === 0;
+    const ops = this.ops(frame, key ? null : this.prev);
+    this.prev = Uint8Array.from(frame);
+    this.frameCount++;
+
+    const packets = [];
+    let start = 0;
+    let body = [];
+    let bodyLen = 0;
+    const flush = (last) => {
+      const p = Buffer.alloc(HEADER_LEN + bodyLen);
+      p[0] = 6;
+      p[1] = this.timeout;
+      p[2] = (key ? FLAG_KEYFRAME : 0) | (this.bpp === 4 ? FLAG_RGBW : 0) | (last ? FLAG_PUSH : 0);
+      this.seq = (this.seq + 1) & 0xFF;
+      p[3] = this.seq;
+      p.writeUInt16BE(start, 4);
+      let o = HEADER_LEN;
+      for (const b of body) { p.set(b, o); o += b.length; }
+      packets.push(p);
+    };
+    let pix = 0;
+    for (const op of ops) {
+      const bytes = 1 + (op.data ? op.data.length : 0);
+      if (HEADER_LEN + bodyLen + bytes > MAX_PACKET) {
+        flush(false);
+        start = pix;
+        body = [];
+        bodyLen = 0;
+        //a packet never starts with unchanged pixels
+        if (op.type === OP_SKIP) { start += op.n; pix += op.n; continue; }
+      }
+      body.push(Uint8Array.of((op.type << 6) | (op.n - 1)));
+      if (op.data) body.push(op.data);
+      bodyLen += bytes;
+      pix += op.n;
+    }
+    flush(true);
+    return packets;
+  }
+}
+
+/* demo effects, frame t of n LEDs as RGB bytes */
+
+function hsv(h) {
+  const s = Math.floor(h * 6) % 6, f = h * 6 - Math.floor(h * 6);
+  const q = Math.round(255 * (1 - f)), t = Math.round(255 * f);
+  return [[255, t, 0], [q, 255, 0], [0, 255, t], [0, q, 255], [t, 0, 255], [255, 0, q]][s];
+}
+
+function lcg(seed) {
+  let x = seed >>> 0;
+  return () => (x = (Math.imul(x, 1664525) + 1013904223) >>> 0) / 4294967296;
+}
+
+const effects = {
+  solid: (n) => (t, f) => f.fill(0).forEach((_, i) => (f[i] = [255, 160, 0][i % 3])),
+  chase: (n) => (t, f) => { f.fill(0); for (let k = 0; k < 5; k++) f.set([255, 255, 255], ((t + k * Math.floor(n / 5)) % n) * 3); },
+  twinkle: (n) => {
+    const rnd = lcg(1), lit = new Uint8Array(n);
+    return (t, f) => {
+      for (let k = 0; k < n / 20; k++) lit[Math.floor(rnd() * n)] ^= 1;
+      for (let i = 0; i < n; i++) f.set(lit[i] ? [255, 200, 120] : [0, 0, 0], i * 3);
+    };
+  },
+  wipe: (n) => (t, f) => { for (let i = 0; i < n; i++) f.set(i <= (t * 3) % (2 * n) && i > (t * 3) % (2 * n) - n ? [0, 80, 255] : [0, 0, 0], i * 3); },
+  rainbow: (n) => (t, f) => { for (let i = 0; i < n; i++) f.set(hsv(((i + t) % n) / n), i * 3); },
+  noise: (n) => { const rnd = lcg(2); return (t, f) => { for (let i = 0; i < f.length; i++) f[i] = rnd() * 256; }; },
+};
+
+function dnrgbBytes(n) {
+  let bytes = 0;
+  for (let i = 0; i < n; i += 489) bytes += 4 + Math.min(489, n - i) * 3 + 28; //+28 IP/UDP header
+  return bytes;
+}
+
+function bench(leds) {
+  const frames = 300;
+  console.log(`${leds} LEDs, ${frames} frames, keyframe every 30 frames, bytes per frame incl. IP/UDP headers`);
+  console.log("effect    DNRGB   DRLE   saved");
+  for (const [name, make] of Object.entries(effects)) {
+    const enc = new DrleEncoder({ leds });
+    const fx = make(leds);
+    const frame = new Uint8Array(leds * 3);
+    let bytes = 0;
+    for (let t = 0; t < frames; t++) {
+      fx(t, frame);
+      for (const p of enc.encode(frame)) bytes += p.length + 28;
+    }
+    const ref = dnrgbBytes(leds);
+    const avg = bytes / frames;
+    console.log(`${name.padEnd(8)} ${String(ref).padStart(6)} ${avg.toFixed(0).padStart(6)} ${(100 * (1 - avg / ref)).toFixed(0).padStart(6)}%`);
+  }
+}
+
+function send(ip, leds, fps, keyframeInterval, port) {
+  const socket = dgram.createSocket("udp4");
+  const enc = new DrleEncoder({ leds, keyframeInterval });
+  const fx = effects.twinkle(leds);
+  const frame = new Uint8Array(leds * 3);
+  let t = 0;
+  setInterval(() => {
+    fx(t++, frame);
+    for (const p of enc.encode(frame)) socket.send(p, port, ip);
+  }, 1000 / fps);
+}
+
+if (require.main === module) {
+  const [cmd, ...args] = process.argv.slice(2);
+  if (cmd === "bench") bench(parseInt(args[0]) || 300);
+  else if (cmd === "send" && args[0]) send(args[0], parseInt(args[1]) || 300, parseInt(args[2]) || 30, parseInt(args[3]) || 30, parseInt(args[4]) || 21324);
+  else console.log("usage: node tools/drle.js bench [leds] | send <ip> [leds] [fps] [keyframe interval] [port]");
+}
+
+module.exports = { DrleEncoder };
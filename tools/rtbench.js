@@ -0,0 +1,340 @@
+/**
+ * Realtime ingest benchmark with recorded packets
+ *
+ * Packets are recorded once, from a real sender or generated for each protocol, and replayed
+ * unchanged against a WLED node. The node measures the time it spends decoding each packet
+ * (info.rt.<protocol>.dec, us) so firmware versions can be compared on exactly the same input.
+ *
+ * How to use it?
+ *
+ * > node tools/rtbench.js record <file> <protocol> [leds] [frames]  generate a recording, protocol: dnrgb, tpm2net, e131, artnet, ddp, drle
+ * > node tools/rtbench.js capture <file> [seconds] [ports]          record what a sender (xLights, Hyperion, ...) sends to this host
+ * > node tools/rtbench.js replay <ip> <file> [fps] [repeat]         send a recording to a node and print its ingest statistics
+ *
+ * A high fps works as a packet generator for the UDP receive loop, e.g. 4 DNRGB packets per frame at 60 fps:
+ * > node tools/rtbench.js record flood.bin dnrgb 1700 600 && node tools/rtbench.js replay <ip> flood.bin 60 5
+ * Packets sent to the notifier and raw RGB ports that the node never handled were lost in its socket queue.
+ *
+ * > node tools/rtbench.js pixels <ip> [leds] [frames]                 upload frames to segment 0 with /pixels and with the JSON "i" array
+ *
+ * Recording file: "WRT1", then per packet: time since the first packet (ms, uint32), UDP port (uint16), length (uint16), data (all big endian)
+ */
+
+const dgram = require("dgram");
+const fs = require("fs");
+const http = require("http");
+
+const MAGIC = "WRT1";
+const PORT_UDP = 21324, PORT_HYPERION = 19446, PORT_TPM2NET = 65506, PORT_E131 = 5568, PORT_ARTNET = 6454, PORT_DDP = 4048;
+const CAPTURE_PORTS = [PORT_UDP, PORT_HYPERION, PORT_TPM2NET, PORT_E131, PORT_ARTNET, PORT_DDP];
+const DRAINED_PORTS = [PORT_UDP, PORT_HYPERION, PORT_TPM2NET];
+//the protocol a port is reported under in info.rt
+const RT_NAMES = { [PORT_UDP]: ["udp"], [PORT_HYPERION]: ["hyperion"], [PORT_TPM2NET]: ["tpm2net"], [PORT_E131]: ["e131"], [PORT_ARTNET]: ["artnet"], [PORT_DDP]: ["ddp"] };
+
+/* recording file */
+
+function writeRecording(file, packets) {
+  const parts = [Buffer.from(MAGIC)];
+  for (const p of packets) {
+    const h = Buffer.alloc(8);
+    h.writeUInt32BE(p.t, 0);
+    h.writeUInt16BE(p.port, 4);
+    h.writeUInt16BE(p.data.length, 6);
+    parts.push(h, p.data);
+  }
+  fs.writeFileSync(file, Buffer.concat(parts));
+}
+
+function readRecording(file) {
+  const b = fs.readFileSync(file);
+  if (b.toString("latin1", 0, 4) !== MAGIC) throw new Error(`${file} is not a recording`);
+  const packets = [];
+  let o = 4;
+  while (o + 8 <= b.length) {
+    const len = b.readUInt16BE(o + 6);
+    packets.push({ t: b.readUInt32BE(o), port: b.readUInt16BE(o + 4), data: b.subarray(o + 8, o + 8 + len) });
+    o += 8 + len;
+  }
+  return packets;
+}
+
+/* packet builders, one frame of RGB bytes in, packets out */
+
+function dnrgb(frame) {
+  const packets = [];
+  for (let i = 0; i < frame.length / 3; i += 489) {
+    const n = Math.min(489, frame.length / 3 - i);
+    const p = Buffer.alloc(4 + n * 3);
+    p[0] = 4; p[1] = 2; p.writeUInt16BE(i, 2);
+    frame.copy(p, 4, i * 3, (i + n) * 3);
+    packets.push({ port: PORT_UDP, data: p });
+  }
+  return packets;
+}
+
+function tpm2net(frame) {
+  const size = 1488; //evenly distributed, see the TPM2.NET handler
+  const num = Math.ceil(frame.length / size);
+  const packets = [];
+  for (let k = 0; k < num; k++) {
+    const chunk = frame.subarray(k * size, (k + 1) * size);
+    const p = Buffer.alloc(7 + chunk.length);
+    p[0] = 0x9c; p[1] = 0xda; p.writeUInt16BE(Math.min(size, frame.length), 2); p[4] = k + 1; p[5] = num;
+    chunk.copy(p, 6);
+    p[6 + chunk.length] = 0x36;
+    packets.push({ port: PORT_TPM2NET, data: p });
+  }
+  return packets;
+}
+
+let e131Seq = 0;
+function e131(frame) {
+  const packets = [];
+  e131Seq = (e131Seq + 1) & 0xFF;
+  for (let u = 0; u * 510 < frame.length; u++) {
+    const data = frame.subarray(u * 510, (u + 1) * 510);
+    const p = Buffer.alloc(126 + data.length);
+    p.writeUInt16BE(0x0010, 0);
+    p.write("ASC-E1.17", 4, "latin1");
+    p.writeUInt16BE(0x7000 | (p.length - 16), 16);
+    p.writeUInt32BE(4, 18);
+    p.write("rtbench", 22, "latin1"); //CID
+    p.writeUInt16BE(0x7000 | (p.length - 38), 38);
+    p.writeUInt32BE(2, 40);
+    p.write("WLED rtbench", 44, "latin1");
+    p[108] = 100; //priority
+    p[111] = e131Seq;
+    p.writeUInt16BE(u + 1, 113);
+    p.writeUInt16BE(0x7000 | (p.length - 115), 115);
+    p[117] = 2; p[118] = 0xa1;
+    p.writeUInt16BE(1, 121);
+    p.writeUInt16BE(data.length + 1, 123);
+    data.copy(p, 126);
+    packets.push({ port: PORT_E131, data: p });
+  }
+  return packets;
+}
+
+let artSeq = 0;
+function artnet(frame) {
+  const packets = [];
+  artSeq = (artSeq % 255) + 1;
+  for (let u = 0; u * 510 < frame.length; u++) {
+    const data = frame.subarray(u * 510, (u + 1) * 510);
+    const p = Buffer.alloc(18 + data.length);
+    p.write("Art-Net", 0, "latin1");
+    p.writeUInt16LE(0x5000, 8);
+    p.writeUInt16BE(14, 10);
+    p[12] = artSeq;
+    p.writeUInt16LE(u + 1, 14);
+    p.writeUInt16BE(data.length, 16);
+    data.copy(p, 18);
+    packets.push({ port: PORT_ARTNET, data: p });
+  }
+  return packets;
+}
+
+let ddpSeq = 0;
+function ddp(frame) {
+  const packets = [];
+  for (let o = 0; o < frame.length; o += 1440) {
+    const data = frame.subarray(o, o + 1440);
+    const p = Buffer.alloc(10 + data.length);
+    ddpSeq = (ddpSeq % 15) + 1;
+    p[0] = 0x40 | (o + 1440 >= frame.length ? 0x01 : 0); //version 1, push on the last packet
+    p[1] = ddpSeq;
+    p[2] = (1 << 3) | 3; //RGB, 8 bit
+    p[3] = 1;
+    p.writeUInt32BE(o, 4);
+    p.writeUInt16BE(data.length, 8);
+    data.copy(p, 10);
+    packets.push({ port: PORT_DDP, data: p });
+  }
+  return packets;
+}
+
+const builders = { dnrgb, tpm2net, e131, artnet, ddp };
+
+/* content: a moving rainbow with a few twinkles, so runs, literals and unchanged pixels all occur */
+
+function hsv(h) {
+  const s = Math.floor(h * 6) % 6, f = h * 6 - Math.floor(h * 6);
+  const q = Math.round(255 * (1 - f)), t = Math.round(255 * f);
+  return [[255, t, 0], [q, 255, 0], [0, 255, t], [0, q, 255], [t, 0, 255], [255, 0, q]][s];
+}
+
+function demoFrame(frame, t, leds) {
+  for (let i = 0; i < leds; i++) frame.set(i < leds / 2 ? hsv(((i + t) % leds) / leds) : [0, 0, 0], i * 3);
+  for (let k = 0; k < leds / 50; k++) frame.set([255, 255, 255], ((k * 7919 + t * 31) % leds) * 3);
+}
+
+function record(file, protocol, leds, frames) {
+  const fps = 40;
+  const packets = [];
+  const frame = Buffer.alloc(leds * 3);
+  let encoder = null;
+  if (protocol === "drle") encoder = new (require("./drle.js").DrleEncoder)({ leds });
+  else if (!builders[protocol]) throw new Error(`unknown protocol ${protocol}`);
+  for (let t = 0; t < frames; t++) {
+    demoFrame(frame, t, leds);
+    const out = encoder ? encoder.encode(frame).map((data) => ({ port: PORT_UDP, data })) : builders[protocol](frame);
+    for (const p of out) packets.push({ t: Math.round((t * 1000) / fps), port: p.port, data: p.data });
+  }
+  writeRecording(file, packets);
+  console.log(`${file}: ${packets.length} ${protocol} packets, ${frames} frames of ${leds} LEDs`);
+}
+
+function capture(file, seconds, ports) {
+  const packets = [];
+  let start = 0;
+  for (const port of ports) {
+    const socket = dgram.createSocket({ type: "udp4", reuseAddr: true });
+    socket.on("message", (msg) => {
+      const now = Date.now();
+      if (!packets.length) start = now;
+      packets.push({ t: now - start, port, data: Buffer.from(msg) });
+    });
+    socket.bind(port, () => {
+      if (port === PORT_E131) for (let u = 1; u <= 8; u++) socket.addMembership(`239.255.0.${u}`);
+    });
+  }
+  console.log(`recording ports ${ports.join(", ")} for ${seconds}s...`);
+  setTimeout(() => {
+    writeRecording(file, packets);
+    console.log(`${file}: ${packets.length} packets`);
+    process.exit(0);
+  }, seconds * 1000);
+}
+
+/* replay */
+
+function getInfo(ip) {
+  return new Promise((resolve, reject) => {
+    http.get(`http://${ip}/json/info`, (res) => {
+      let body = "";
+      res.on("data", (d) => (body += d));
+      res.on("end", () => { try { resolve(JSON.parse(body)); } catch (e) { reject(e); } });
+    }).on("error", reject);
+  });
+}
+
+function sleep(ms) {
+  return new Promise((r) => setTimeout(r, ms));
+}
+
+async function replay(ip, file, fps, repeat) {
+  const packets = readRecording(file);
+  if (!packets.length) throw new Error(`${file} is empty`);
+  const socket = dgram.createSocket("udp4");
+  const send = (p) => new Promise((r) => socket.send(p.data, p.port, ip, r));
+  const before = await getInfo(ip);
+  const ports = new Set(packets.map((p) => p.port));
+
+  //packets with the same timestamp belong to one frame, fps overrides the recorded timing
+  const started = Date.now();
+  let sent = 0;
+  for (let r = 0; r < repeat; r++) {
+    const base = Date.now();
+    let frame = 0;
+    for (let i = 0; i < packets.length; i++) {
+      if (i && packets[i].t !== packets[i - 1].t) frame++;
+      const due = fps ? (frame * 1000) / fps : packets[i].t;
+      const wait = base + due - Date.now();
+      if (wait > 0) await sleep(wait);
+      await send(packets[i]);
+      sent++;
+    }
+  }
+  const secs = (Date.now() - started) / 1000;
+  await sleep(1500); //the per second rates are updated once a second
+  const after = await getInfo(ip);
+  socket.close();
+
+  console.log(`${file}: sent ${sent} packets in ${secs.toFixed(1)}s to ${ip} (${after.ver}, ${after.leds.count} LEDs)`);
+  console.log("protocol   packets  frames   dec us  lat us");
+  for (const port of ports) {
+    for (const name of RT_NAMES[port] || []) {
+      const a = (after.rt || {})[name], b = (before.rt || {})[name] || { n: 0, frames: 0 };
+      if (!a) continue;
+      console.log(`${name.padEnd(9)} ${String(a.n - b.n).padStart(8)} ${String(a.frames - b.frames).padStart(7)} ${String(a.dec).padStart(8)} ${String(a.lat).padStart(7)}`);
+    }
+  }
+
+  //the notifier and raw RGB sockets are drained by handleNotifications(), packets it never saw were lost in the socket queue
+  const drained = packets.filter((p) => DRAINED_PORTS.includes(p.port)).length * repeat;
+  if (drained && after.udprx && before.udprx) {
+    const handled = after.udprx.n - before.udprx.n;
+    console.log(`udp drain: sent ${drained}, handled ${handled}, lost in the queue ${Math.max(0, drained - handled)}, rejected ${after.udprx.rej - before.udprx.rej},` +
+      ` loops with packets left ${after.udprx.defer - before.udprx.defer}, max. per loop ${after.udprx.qmax}`);
+  }
+}
+
+/* segment pixel upload: binary /pixels against the JSON "i" array of /json/state */
+
+const PIXEL_SET_MAX_LEN = 16384;
+const JSON_I_LEDS = 200; //LEDs per JSON request, the state document of an ESP8266 holds little more
+
+function post(ip, path, body, type) {
+  return new Promise((resolve, reject) => {
+    const req = http.request({ host: ip, path, method: "POST", headers: { "Content-Type": type, "Content-Length": body.length } }, (res) => {
+      res.resume();
+      res.on("end", () => (res.statusCode === 200 ? resolve() : reject(new Error(`${path}: HTTP ${res.statusCode}`))));
+    });
+    req.on("error", reject);
+    req.end(body);
+  });
+}
+
+function pixelRequests(frame, leds) {
+  const max = Math.floor((PIXEL_SET_MAX_LEN - 4) / 3);
+  const bin = [], json = [];
+  for (let i = 0; i < leds; i += max) {
+    const n = Math.min(max, leds - i);
+    const b = Buffer.alloc(4 + n * 3);
+    b[0] = 0; b[1] = 0; b.writeUInt16BE(i, 2);
+    frame.copy(b, 4, i * 3, (i + n) * 3);
+    bin.push(b);
+  }
+  for (let i = 0; i < leds; i += JSON_I_LEDS) {
+    const arr = [i];
+    for (let k = i; k < Math.min(leds, i + JSON_I_LEDS); k++) arr.push([frame[k * 3], frame[k * 3 + 1], frame[k * 3 + 2]]);
+    json.push(Buffer.from(JSON.stringify({ seg: { id: 0, i: arr } })));
+  }
+  return { bin, json };
+}
+
+async function pixels(ip, leds, frames) {
+  const frame = Buffer.alloc(leds * 3);
+  const runs = [
+    { name: "/pixels", path: "/pixels", type: "application/octet-stream", key: "bin" },
+    { name: "json i", path: "/json/state", type: "application/json", key: "json" },
+  ];
+  console.log(`${ip}: ${frames} frames of ${leds} LEDs to segment 0, one request at a time`);
+  console.log("path       requests   bytes/frame   ms/frame   frames/s");
+  for (const run of runs) {
+    let requests = 0, bytes = 0;
+    const started = Date.now();
+    for (let t = 0; t < frames; t++) {
+      demoFrame(frame, t, leds);
+      for (const body of pixelRequests(frame, leds)[run.key]) {
+        await post(ip, run.path, body, run.type);
+        requests++;
+        bytes += body.length;
+      }
+    }
+    const ms = (Date.now() - started) / frames;
+    console.log(`${run.name.padEnd(9)} ${String(requests).padStart(9)} ${String(Math.round(bytes / frames)).padStart(13)} ${ms.toFixed(1).padStart(10)} ${(1000 / ms).toFixed(1).padStart(10)}`);
+  }
+  await post(ip, "/json/state", Buffer.from(JSON.stringify({ seg: { id: 0, frz: false } })), "application/json");
+}
+
+if (require.main === module) {
+  const [cmd, ...args] = process.argv.slice(2);
+  if (cmd === "record" && args[1]) record(args[0], args[1], parseInt(args[2]) || 510, parseInt(args[3]) || 400);
+  else if (cmd === "capture" && args[0]) capture(args[0], parseInt(args[1]) || 10, args[2] ? args[2].split(",").map(Number) : CAPTURE_PORTS);
+  else if (cmd === "replay" && args[1]) replay(args[0], args[1], parseFloat(args[2]) || 0, parseInt(args[3]) || 1).catch((e) => { console.error(e.message); process.exit(1); });
+  else if (cmd === "pixels" && args[0]) pixels(args[0], parseInt(args[1]) || 300, parseInt(args[2]) || 100).catch((e) => { console.error(e.message); process.exit(1); });
+  else console.log("usage: node tools/rtbench.js record <file> <protocol> [leds] [frames] | capture <file> [seconds] [ports] | replay <ip> <file> [fps] [repeat] | pixels <ip> [leds] [frames]");
+}
+
+module.exports = { readRecording, writeRecording, builders };
@@ -3816,22 +3816,29 @@ uint16_t WS2812FX::mode_washing_machine(void) {
   Blends random colors across palette
   Modified, originally by Mark Kriegsman https://gist.github.com/kriegsman/1f7ccbbfa492a73c015e
 */
-uint16_t WS2812FX::mode_blends(void) {
-  uint16_t dataSize = sizeof(uint32_t) * SEGLEN;
+template<uint8_t BPP> uint16_t WS2812FX::blends_base(void) {
+  uint16_t dataSize = BPP * SEGLEN;
   if (!SEGENV.allocateData(dataSize)) return mode_static(); //allocation failed
-  uint32_t* pixels = reinterpret_cast<uint32_t*>(SEGENV.data);
+  byte* pixels = SEGENV.data;
   uint8_t blendSpeed = map(SEGMENT.intensity, 0, UINT8_MAX, 10, 128);
-    uint8_t shift = (now * ((SEGMENT.speed >> 3) +1)) >> 8;
+  uint8_t shift = (now * ((SEGMENT.speed >> 3) +1)) >> 8;
 
   for (int i = 0; i < SEGLEN; i++) {
-    pixels[i] = color_blend(pixels[i], color_from_palette(shift + quadwave8((i + 1) * 16), false, PALETTE_SOLID_WRAP, 255), blendSpeed);
-    setPixelColor(i, pixels[i]);
+    uint32_t c = color_blend(PixelStore<BPP>::get(pixels, i), color_from_palette(shift + quadwave8((i + 1) * 16), false, PALETTE_SOLID_WRAP, 255), blendSpeed);
+    PixelStore<BPP>::set(pixels, i, c);
+    setPixelColor(i, c);
     shift += 3;
   }
 
   return FRAMETIME;
 }
 
+uint16_t WS2812FX::mode_blends(void) {
+  //RGB-only strips store 3 bytes per pixel, fitting a third more LEDs into MAX_SEGMENT_DATA
+  if (getPixelBytes() == 4) return blends_base<4>();
+  return blends_base<3>();
+}
+
 #ifndef WLED_DISABLE_FX_HIGH_FLASH_USE
 typedef struct TvSim {
   uint32_t totalTime = 0;
@@ -71,6 +71,8 @@
 
 #define LED_SKIP_AMOUNT  1
 #define MIN_SHOW_DELAY  15
+#define FRAME_GRID_SPIN  500 /* us before a frame grid slot boundary that service() waits for it instead of returning */
+#define FRAME_GRID_LATE  2 /* ms after the slot boundary a frame is counted as shown late */
 
 #define NUM_COLORS       3 /* number of colors per segment */
 #define SEGMENT          _segments[_segment_index]
@@ -95,6 +97,33 @@
 #define PINK       (uint32_t)0xFF1493
 #define ULTRAWHITE (uint32_t)0xFFFFFFFF
 
+// per-pixel color storage for effect and realtime buffers, 3 bytes per pixel unless the strip has a white channel.
+// Pick the variant with WS2812FX::getPixelBytes() (follows BusManager::isRgbw() of the configured busses)
+template<uint8_t BPP> struct PixelStore {
+  static uint32_t get(const byte* buf, uint16_t i);
+  static void set(byte* buf, uint16_t i, uint32_t c);
+};
+
+template<> inline uint32_t PixelStore<3>::get(const byte* buf, uint16_t i) {
+  const byte* p = buf + i*3;
+  return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+}
+
+template<> inline void PixelStore<3>::set(byte* buf, uint16_t i, uint32_t c) {
+  byte* p = buf + i*3;
+  p[0] = c >> 16; p[1] = c >> 8; p[2] = c;
+}
+
+template<> inline uint32_t PixelStore<4>::get(const byte* buf, uint16_t i) {
+  uint32_t c;
+  memcpy(&c, buf + i*4, 4); //buffer may be unaligned
+  return c;
+}
+
+template<> inline void PixelStore<4>::set(byte* buf, uint16_t i, uint32_t c) {
+  memcpy(buf + i*4, &c, 4);
+}
+
 // options
 // bit    7: segment is in transition mode
 // bits 4-6: TBD
@@ -584,7 +613,7 @@ class WS2812FX {
     }
 
     void
-      finalizeInit(uint16_t countPixels, bool skipFirst),
+      finalizeInit(uint16_t countPixels, bool skipFirst, bool loadMap = true),
       service(void),
       blur(uint8_t),
       fill(uint32_t),
@@ -603,10 +632,15 @@ class WS2812FX {
       resetSegments(),
       setPixelColor(uint16_t n, uint32_t c),
       setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0),
+      setRealtimePixels(uint16_t start, const uint8_t* data, uint16_t count, uint8_t stride, bool gamma),
+      setSegmentPixels(uint16_t i, const uint8_t* data, uint16_t count, uint8_t stride),
       show(void),
       setColorOrder(uint8_t co),
       setPixelSegment(uint8_t n);
 
+    inline void cancelFrame() { _framePending = false; } //realtime data replaced the rendered frame
+    inline uint8_t getPixelBytes() { return isRgbw ? 4 : 3; } //bytes per pixel of PixelStore buffers
+
     bool
       isRgbw = false,
       gammaCorrectBri = false,
@@ -649,6 +683,7 @@ class WS2812FX {
     uint16_t
       ablMilliampsMax,
       currentMilliamps,
+      framePeriod = 0, // frame grid slot length in ms, slots start at multiples of it on the effect clock (0 = off)
 //      setStripLen(uint8_t strip, uint16_t len),
 //      getStripLen(uint8_t strip=0),
       triwave16(uint16_t),
@@ -657,6 +692,10 @@ class WS2812FX {
     uint32_t
       now,
       timebase,
+      frameShown = 0,  // frame grid slots shown
+      frameMissed = 0, // frame grid slots without a frame, rendering or the loop was too slow
+      frameLate = 0,   // frames shown more than FRAME_GRID_LATE ms after their slot boundary
+      getBusMemReserve(bool jsonBufferAllocated),
       color_wheel(uint8_t),
       color_from_palette(uint16_t, bool mapping, bool wrap, uint8_t mcol, uint8_t pbri = 255),
       color_blend(uint32_t,uint32_t,uint16_t,bool b16=false),
@@ -844,10 +883,13 @@ class WS2812FX {
       spots_base(uint16_t),
       phased_base(uint8_t);
 
+    template<uint8_t BPP> uint16_t blends_base(void);
+
     CRGB twinklefox_one_twinkle(uint32_t ms, uint8_t salt, bool cat);
     CRGB pacifica_one_layer(uint16_t i, CRGBPalette16& p, uint16_t cistart, uint16_t wavescale, uint8_t bri, uint16_t ioff);
 
     void
+      autoWhite(uint8_t &r, uint8_t &g, uint8_t &b, uint8_t &w),
       blendPixelColor(uint16_t n, uint32_t color, uint8_t blend),
       startTransition(uint8_t oldBri, uint32_t oldCol, uint16_t dur, uint8_t segn, uint8_t slot),
       deserializeMap(void);
@@ -857,6 +899,9 @@ class WS2812FX {
     
     uint32_t _lastPaletteChange = 0;
     uint32_t _lastShow = 0;
+    uint32_t _frameSlot = 0;     // effect clock of the slot boundary the rendered frame is waiting for
+    uint32_t _frameSlotUs = 0;   // micros() of that boundary
+    bool _framePending = false;
 
     uint32_t _colors_t[3];
     uint8_t _bri_t;
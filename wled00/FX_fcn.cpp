@@ -44,7 +44,8 @@
 */
 
 //do not call this method from system context (network callback)
-void WS2812FX::finalizeInit(uint16_t countPixels, bool skipFirst)
+//loadMap = false keeps the current custom LED map instead of re-reading ledmap.json
+void WS2812FX::finalizeInit(uint16_t countPixels, bool skipFirst, bool loadMap)
 {
   RESET_RUNTIME;
   _length = countPixels;
@@ -62,7 +63,7 @@ void WS2812FX::finalizeInit(uint16_t countPixels, bool skipFirst)
     busses.add(defCfg);
   }
   
-  deserializeMap();
+  if (loadMap) deserializeMap();
 
   //make segment 0 cover the entire strip
   _segments[0].start = 0;
@@ -85,7 +86,34 @@ void WS2812FX::finalizeInit(uint16_t countPixels, bool skipFirst)
 void WS2812FX::service() {
   uint32_t nowUp = millis(); // Be aware, millis() rolls over every 49 days
   now = nowUp + timebase;
-  if (nowUp - _lastShow < MIN_SHOW_DELAY) return;
+  if (framePeriod) {
+    //frame grid: the frame of the next slot is rendered ahead and shown at the slot boundary
+    //all nodes with a synchronized timebase show their frames at the same time
+    if (_framePending) {
+      int32_t wait = _frameSlot - now;
+      if (wait < 0 && (uint32_t)-wait >= framePeriod) { //too late, render the next slot instead
+        frameMissed += (uint32_t)-wait / framePeriod;
+        _framePending = false;
+      } else {
+        //the boundary in micros() is only spun for in the last FRAME_GRID_SPIN us, loop() comes back in time for most slots
+        int32_t waitUs = _frameSlotUs - micros();
+        if (waitUs > FRAME_GRID_SPIN || wait > 1) return; //wait also follows timebase changes
+        if (waitUs > 0) delayMicroseconds(waitUs);
+        else if (-wait > FRAME_GRID_LATE) frameLate++;
+      }
+      if (_framePending) {
+        show();
+        frameShown++;
+        _framePending = false;
+      }
+      nowUp = millis();
+      now = nowUp + timebase;
+    }
+    _frameSlot = (now / framePeriod + 1) * framePeriod;
+    _frameSlotUs = micros() + (_frameSlot - now) * 1000;
+    nowUp += _frameSlot - now;
+    now = _frameSlot;
+  } else if (nowUp - _lastShow < MIN_SHOW_DELAY) return;
   bool doShow = false;
 
   for(uint8_t i=0; i < MAX_NUM_SEGMENTS; i++)
@@ -126,7 +154,8 @@ void WS2812FX::service() {
   _virtualSegmentLength = 0;
   if(doShow) {
     yield();
-    show();
+    if (framePeriod) _framePending = true;
+    else show();
   }
   _triggered = false;
 }
@@ -158,21 +187,24 @@ uint16_t WS2812FX::realPixelIndex(uint16_t i) {
   return realIndex;
 }
 
-void WS2812FX::setPixelColor(uint16_t i, byte r, byte g, byte b, byte w)
+//auto calculate white channel value if enabled
+void WS2812FX::autoWhite(byte &r, byte &g, byte &b, byte &w)
 {
-  //auto calculate white channel value if enabled
-  if (isRgbw) {
-    if (rgbwMode == RGBW_MODE_AUTO_BRIGHTER || (w == 0 && (rgbwMode == RGBW_MODE_DUAL || rgbwMode == RGBW_MODE_LEGACY)))
-    {
-      //white value is set to lowest RGB channel
-      //thank you to @Def3nder!
-      w = r < g ? (r < b ? r : b) : (g < b ? g : b);
-    } else if (rgbwMode == RGBW_MODE_AUTO_ACCURATE && w == 0)
-    {
-      w = r < g ? (r < b ? r : b) : (g < b ? g : b);
-      r -= w; g -= w; b -= w;
-    }
+  if (rgbwMode == RGBW_MODE_AUTO_BRIGHTER || (w == 0 && (rgbwMode == RGBW_MODE_DUAL || rgbwMode == RGBW_MODE_LEGACY)))
+  {
+    //white value is set to lowest RGB channel
+    //thank you to @Def3nder!
+    w = r < g ? (r < b ? r : b) : (g < b ? g : b);
+  } else if (rgbwMode == RGBW_MODE_AUTO_ACCURATE && w == 0)
+  {
+    w = r < g ? (r < b ? r : b) : (g < b ? g : b);
+    r -= w; g -= w; b -= w;
   }
+}
+
+void WS2812FX::setPixelColor(uint16_t i, byte r, byte g, byte b, byte w)
+{
+  if (isRgbw) autoWhite(r, g, b, w);
   
   uint16_t skip = _skipFirstMode ? LED_SKIP_AMOUNT : 0;
   if (SEGLEN) {//from segment
@@ -974,6 +1006,19 @@ bool WS2812FX::segmentsAreIdentical(Segment* a, Segment* b)
 }
 
 
+//heap that has to stay free after the busses are created: the remaining segment data,
+//the LED map (if it still has to be loaded) and the JSON buffer used to parse it or the next request
+uint32_t WS2812FX::getBusMemReserve(bool jsonBufferAllocated) {
+  uint32_t reserve = WLED_HEAP_RESERVE + MAX_SEGMENT_DATA - _usedSegmentData;
+  if (!jsonBufferAllocated) reserve += JSON_BUFFER_SIZE;
+  if (customMappingTable == nullptr && WLED_FS.exists("/ledmap.json")) {
+    File f = WLED_FS.open("/ledmap.json", "r");
+    if (f) reserve += f.size(); //the table is never larger than its JSON representation
+    f.close();
+  }
+  return reserve;
+}
+
 //load custom mapping table from JSON file
 void WS2812FX::deserializeMap(void) {
   if (!WLED_FS.exists("/ledmap.json")) return;
@@ -1034,6 +1079,58 @@ uint8_t WS2812FX::gamma8(uint8_t b)
   return gammaT[b];
 }
 
+//bulk setPixelColor() for live data straight from a receive buffer.
+//data holds count pixels of R,G,B(,W) bytes, stride apart (stride 4 = RGBW)
+void WS2812FX::setRealtimePixels(uint16_t start, const byte* data, uint16_t count, uint8_t stride, bool gamma)
+{
+  uint16_t skip = _skipFirstMode ? LED_SKIP_AMOUNT : 0;
+  bool hasWhite = (stride > 3);
+  for (uint16_t i = start; i < start + count; i++, data += stride) {
+    byte r = data[0], g = data[1], b = data[2], w = hasWhite ? data[3] : 0;
+    if (gamma) {
+      r = gammaT[r]; g = gammaT[g]; b = gammaT[b]; w = gammaT[w];
+    }
+    if (isRgbw) autoWhite(r, g, b, w);
+    uint16_t pix = (i < customMappingSize) ? customMappingTable[i] : i;
+    busses.setPixelColor(pix + skip, ((w << 24) | (r << 16) | (g << 8) | (b)));
+  }
+  if (skip && start == 0 && count) {
+    for (uint16_t j = 0; j < skip; j++) {
+      busses.setPixelColor(j, BLACK);
+    }
+  }
+}
+
+//bulk setPixelColor() for count pixels of the segment selected with setPixelSegment(), from segment index i on.
+//Grouped, spaced, reversed and mirrored segments are left to setPixelColor()
+void WS2812FX::setSegmentPixels(uint16_t i, const byte* data, uint16_t count, uint8_t stride)
+{
+  bool hasWhite = (stride > 3);
+  if (!SEGLEN || SEGMENT.groupLength() > 1 || IS_REVERSE || IS_MIRROR) {
+    for (uint16_t j = i; j < i + count; j++, data += stride) {
+      setPixelColor(j, data[0], data[1], data[2], hasWhite ? data[3] : 0);
+    }
+    return;
+  }
+  uint16_t skip = _skipFirstMode ? LED_SKIP_AMOUNT : 0;
+  uint16_t end = SEGMENT.start + i + count;
+  if (end > SEGMENT.stop) end = SEGMENT.stop;
+  for (uint16_t pix = SEGMENT.start + i; pix < end; pix++, data += stride) {
+    byte r = data[0], g = data[1], b = data[2], w = hasWhite ? data[3] : 0;
+    if (isRgbw) autoWhite(r, g, b, w);
+    if (_bri_t < 255) {
+      r = scale8(r, _bri_t); g = scale8(g, _bri_t); b = scale8(b, _bri_t); w = scale8(w, _bri_t);
+    }
+    uint16_t index = (pix < customMappingSize) ? customMappingTable[pix] : pix;
+    busses.setPixelColor(index + skip, ((w << 24) | (r << 16) | (g << 8) | (b)));
+  }
+  if (skip && i == 0 && count) {
+    for (uint16_t j = 0; j < skip; j++) {
+      busses.setPixelColor(j, BLACK);
+    }
+  }
+}
+
 uint32_t WS2812FX::gamma32(uint32_t color)
 {
   if (!gammaCorrectCol) return color;
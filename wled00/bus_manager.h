@@ -17,6 +17,7 @@ struct BusConfig {
   uint16_t start = 0;
   uint8_t colorOrder = COL_ORDER_GRB;
   bool reversed = false;
+  uint8_t splitGroup = 0; //>0 if this is one part of a logical LED range split across several outputs
   uint8_t pins[5] = {LEDPIN, 255, 255, 255, 255};
   BusConfig(uint8_t busType, uint8_t* ppins, uint16_t pstart, uint16_t len = 1, uint8_t pcolorOrder = COL_ORDER_GRB, bool rev = false) {
     type = busType; count = len; start = pstart; colorOrder = pcolorOrder; reversed = rev;
@@ -27,6 +28,40 @@ struct BusConfig {
   }
 };
 
+//reason a bus config was not turned into a bus, for reporting in /json/info
+struct BusRejection {
+  uint8_t  cfgNr = 0;     //index of the config in the order it was added
+  uint8_t  type = TYPE_NONE;
+  uint16_t count = 0;
+  uint8_t  reason = BUS_REJECT_NONE;
+  uint32_t needed = 0;    //estimated bytes the bus would allocate
+  uint32_t available = 0; //bytes that were left in the budget
+};
+
+//transmission timing of a bus, all times in us. Averages are running averages over the last ~8 frames
+struct BusTiming {
+  uint32_t shows = 0;    //number of show() calls since the last reset
+  uint32_t showAvg = 0;  //time spent in show()
+  uint32_t showMax = 0;
+  uint32_t busyAvg = 0;  //time from the end of show() until canShow() was first seen true (resolution is one loop() pass)
+  uint32_t busyMax = 0;
+
+  void addShow(uint32_t t) {
+    showAvg = shows ? (7 * showAvg + t) >> 3 : t;
+    if (t > showMax) showMax = t;
+    shows++;
+  }
+
+  void addBusy(uint32_t t) {
+    busyAvg = busyMax ? (7 * busyAvg + t) >> 3 : t;
+    if (t > busyMax) busyMax = t;
+  }
+
+  void reset() {
+    shows = 0; showAvg = 0; showMax = 0; busyAvg = 0; busyMax = 0;
+  }
+};
+
 //parent class of BusDigital and BusPwm
 class Bus {
   public:
@@ -51,6 +86,36 @@ class Bus {
 
   virtual uint8_t getPins(uint8_t* pinArray) { return 0; }
 
+  //bytes actually allocated for this bus (pixel and driver buffers)
+  virtual uint32_t getMemUsage() { return 0; }
+
+  //theoretical time in us to send one frame at the protocol's bit rate
+  virtual uint32_t getWireTime() { return 0; }
+
+  //show() with timing probe
+  void showTimed() {
+    probeBusy(); //a bus that is still sending blocks in show(), that time counts as show time
+    uint32_t start = micros();
+    show();
+    _lastShowEnd = micros();
+    _showPending = true;
+    timing.addShow(_lastShowEnd - start);
+  }
+
+  //canShow() with timing probe, records how long the bus stayed busy after the last show()
+  bool probeBusy() {
+    if (!_showPending) return true;
+    if (!canShow()) return false;
+    _showPending = false;
+    timing.addBusy(micros() - _lastShowEnd);
+    return true;
+  }
+
+  BusTiming timing;
+
+  bool reversed = false;
+  uint8_t splitGroup = 0; //busses with the same non-zero group are parts of one logical LED range
+
   uint16_t getStart() {
     return _start;
   }
@@ -63,7 +128,7 @@ class Bus {
     return 1;
   }
 
-  virtual void setColorOrder() {}
+  virtual void setColorOrder(uint8_t colorOrder) {}
 
   virtual uint8_t getColorOrder() {
     return COL_ORDER_RGB;
@@ -77,13 +142,13 @@ class Bus {
     return _valid;
   }
 
-  bool reversed = false;
-
   protected:
   uint8_t _type = TYPE_NONE;
   uint8_t _bri = 255;
   uint16_t _start = 0;
   bool _valid = false;
+  bool _showPending = false;
+  uint32_t _lastShowEnd = 0;
 };
 
 
@@ -101,10 +166,12 @@ class BusDigital : public Bus {
     }
     _len = bc.count;
     reversed = bc.reversed;
+    splitGroup = bc.splitGroup;
     _iType = PolyBus::getI(bc.type, _pins, nr);
     if (_iType == I_NONE) return;
     _busPtr = PolyBus::create(_iType, _pins, _len);
     _valid = (_busPtr != nullptr);
+    _memUsage = PolyBus::getDataSize(_busPtr, _iType);
     _colorOrder = bc.colorOrder;
     //Serial.printf("Successfully inited strip %u (len %u) with type %u and pins %u,%u (itype %u)\n",nr, len, type, pins[0],pins[1],_iType);
   };
@@ -146,6 +213,14 @@ class BusDigital : public Bus {
     return _len;
   }
 
+  uint32_t getMemUsage() {
+    return _memUsage;
+  }
+
+  uint32_t getWireTime() {
+    return PolyBus::getWireTime(_iType, _len);
+  }
+
   uint8_t getPins(uint8_t* pinArray) {
     uint8_t numPins = IS_2PIN(_type) ? 2 : 1;
     for (uint8_t i = 0; i < numPins; i++) pinArray[i] = _pins[i];
@@ -167,6 +242,7 @@ class BusDigital : public Bus {
     _iType = I_NONE;
     _valid = false;
     _busPtr = nullptr;
+    _memUsage = 0;
     pinManager.deallocatePin(_pins[0]);
     pinManager.deallocatePin(_pins[1]);
   }
@@ -180,6 +256,7 @@ class BusDigital : public Bus {
   uint8_t _pins[2] = {255, 255};
   uint8_t _iType = I_NONE;
   uint16_t _len = 0;
+  uint32_t _memUsage = 0;
   void * _busPtr = nullptr;
 };
 
@@ -259,6 +336,10 @@ class BusPwm : public Bus {
     _bri = b;
   }
 
+  uint32_t getMemUsage() {
+    return sizeof(_data);
+  }
+
   uint8_t getPins(uint8_t* pinArray) {
     uint8_t numPins = NUM_PWM_PINS(_type);
     for (uint8_t i = 0; i < numPins; i++) pinArray[i] = _pins[i];
@@ -303,31 +384,55 @@ class BusManager {
 
   };
 
-  //utility to get the approx. memory usage of a given BusConfig
+  //estimate of the memory a bus created from the given BusConfig will allocate (same model as Bus::getMemUsage())
+  uint32_t memUsage(BusConfig &bc, uint8_t busNr) {
+    if (!IS_DIGITAL(bc.type)) return 5;
+    return PolyBus::getDataSize(PolyBus::getI(bc.type, bc.pins, busNr), bc.count);
+  }
+
   uint32_t memUsage(BusConfig &bc) {
-    uint8_t type = bc.type;
-    uint16_t len = bc.count;
-    if (type < 32) {
-      #ifdef ESP8266
-        if (bc.pins[0] == 3) { //8266 DMA uses 5x the mem
-          if (type > 29) return len*20; //RGBW
-          return len*15;
-        }
-        if (type > 29) return len*4; //RGBW
-        return len*3;
-      #else //ESP32 RMT uses double buffer?
-        if (type > 29) return len*8; //RGBW
-        return len*6;
-      #endif
+    return memUsage(bc, numBusses);
+  }
+
+  //starts a new round of bus creation. reserve is the heap that must stay free afterwards
+  //for segment data, the custom LED map and JSON buffers
+  void resetAdmission(uint32_t reserve) {
+    _memReserve = reserve;
+    _memAdmitted = 0;
+    _numConfigs = 0;
+    _numRejected = 0;
+  }
+
+  //checks a config against MAX_LED_MEMORY and the free heap, records the reason if it does not fit.
+  //allocated is true for busses that are kept from a previous configuration (their buffers are not part of the free heap)
+  bool admit(BusConfig &bc, uint32_t needed, bool allocated = false) {
+    uint8_t cfgNr = _numConfigs++;
+    uint8_t reason = BUS_REJECT_NONE;
+    uint32_t available = 0;
+    if (numBusses >= WLED_MAX_BUSSES) {
+      reason = BUS_REJECT_COUNT;
+    } else if (_memAdmitted + needed > MAX_LED_MEMORY) {
+      reason = BUS_REJECT_MAXMEM;
+      available = MAX_LED_MEMORY - _memAdmitted;
+    } else if (!allocated) {
+      uint32_t freeHeap = ESP.getFreeHeap();
+      available = (freeHeap > _memReserve) ? freeHeap - _memReserve : 0;
+      if (needed > available) reason = BUS_REJECT_HEAP;
     }
-
-    if (type > 31 && type < 48) return 5;
-    if (type == 44 || type == 45) return len*4; //RGBW
-    return len*3;
+    if (reason == BUS_REJECT_NONE) {
+      _memAdmitted += needed;
+      return true;
+    }
+    if (_numRejected < WLED_MAX_BUSSES) {
+      BusRejection &r = _rejected[_numRejected++];
+      r.cfgNr = cfgNr; r.type = bc.type; r.count = bc.count; r.reason = reason;
+      r.needed = needed; r.available = available;
+    }
+    return false;
   }
-  
+
   int add(BusConfig &bc) {
-    if (numBusses >= WLED_MAX_BUSSES) return -1;
+    if (!admit(bc, memUsage(bc))) return -1;
     if (IS_DIGITAL(bc.type)) {
       busses[numBusses] = new BusDigital(bc, numBusses);
     } else {
@@ -337,6 +442,157 @@ class BusManager {
     return numBusses -1;
   }
 
+  //length of part k when count LEDs are split into numParts contiguous parts
+  static uint16_t splitLength(uint16_t count, uint8_t numParts, uint8_t k) {
+    return count / numParts + (k < count % numParts);
+  }
+
+  //partitions one logical LED range into contiguous parts of (nearly) equal length, one bus per data pin.
+  //pins are in wiring order, pins[0] feeds the first piece of the strip. Only for single pin digital types.
+  //Returns the number of busses added
+  uint8_t addSplit(BusConfig &bc, const uint8_t* pins, uint8_t numPins, uint8_t group) {
+    if (!IS_DIGITAL(bc.type) || IS_2PIN(bc.type) || numPins < 2) {
+      return (add(bc) >= 0);
+    }
+    if (numPins > bc.count) numPins = bc.count;
+    uint8_t added = 0;
+    uint16_t start = bc.start;
+    for (uint8_t k = 0; k < numPins; k++) {
+      BusConfig part = bc;
+      part.start = start;
+      part.count = splitLength(bc.count, numPins, k);
+      part.pins[0] = pins[bc.reversed ? numPins -1 -k : k];
+      part.splitGroup = group;
+      start += part.count;
+      if (add(part) >= 0) added++;
+    }
+    return added;
+  }
+
+  //fills pins[numParts..numOutputs-1] with pins a split could still use, for planSplit(). taken are the pins of all busses.
+  //On ESP8266 the driver depends on the pin, so unused DMA, UART1 and UART0 pins come first, then bit-banged ones (255).
+  //On ESP32 it depends on the bus index only, so the last part's pin is repeated
+  static void planFreePins(uint8_t* pins, uint8_t numParts, uint8_t numOutputs, const uint8_t* taken, uint8_t numTaken) {
+    #ifdef ESP8266
+    const uint8_t hwPins[] = {3, 2, 1};
+    uint8_t h = 0;
+    for (uint8_t k = numParts; k < numOutputs; k++) {
+      pins[k] = 255;
+      for (; h < sizeof(hwPins); h++) {
+        bool used = false;
+        for (uint8_t j = 0; j < numTaken; j++) if (taken[j] == hwPins[h]) used = true;
+        if (!used) { pins[k] = hwPins[h++]; break; }
+      }
+    }
+    #else
+    for (uint8_t k = numParts; k < numOutputs; k++) pins[k] = pins[numParts -1];
+    #endif
+  }
+
+  //estimated frame rate of count LEDs split across numPins outputs, the first one being bus firstBusNr.
+  //Busses with asynchronous drivers (RMT, I2S, ESP8266 DMA) send in parallel, the others one after another
+  static uint16_t planSplit(uint8_t type, uint16_t count, const uint8_t* pins, uint8_t numPins, uint8_t firstBusNr) {
+    if (numPins == 0 || count == 0) return 0;
+    uint32_t asyncTime = 0, syncTime = 0;
+    for (uint8_t k = 0; k < numPins; k++) {
+      uint8_t partPins[2] = {pins[k], 255};
+      uint8_t iType = PolyBus::getI(type, partPins, firstBusNr + k);
+      if (iType == I_NONE) return 0; //more outputs than the hardware has
+      uint32_t wire = PolyBus::getWireTime(iType, splitLength(count, numPins, k));
+      if (PolyBus::isAsync(iType)) { if (wire > asyncTime) asyncTime = wire; }
+      else syncTime += wire;
+    }
+    uint32_t frameTime = asyncTime + syncTime;
+    if (frameTime < 1000000 / 65535) return 65535;
+    return 1000000 / frameTime;
+  }
+
+  //bytes actually allocated by all busses
+  uint32_t getMemUsage() {
+    uint32_t mem = 0;
+    for (uint8_t i = 0; i < numBusses; i++) mem += busses[i]->getMemUsage();
+    return mem;
+  }
+
+  uint8_t getNumRejected() {
+    return _numRejected;
+  }
+
+  BusRejection* getRejected(uint8_t nr) {
+    if (nr >= _numRejected) return nullptr;
+    return &_rejected[nr];
+  }
+
+  //true if the bus has to be re-created to match the config (type, pins or length changed)
+  bool needsRebuild(Bus* b, BusConfig &bc) {
+    if (b == nullptr || !b->isOk()) return true;
+    if (b->getType() != bc.type) return true;
+    if (IS_DIGITAL(bc.type) && b->getLength() != bc.count) return true;
+    uint8_t pins[5] = {255, 255, 255, 255, 255};
+    uint8_t nPins = b->getPins(pins);
+    for (uint8_t i = 0; i < nPins; i++) {
+      if (pins[i] != bc.pins[i]) return true;
+    }
+    return false;
+  }
+
+  //applies the settings that do not require the bus to be re-created
+  void updateInPlace(Bus* b, BusConfig &bc) {
+    if (b == nullptr) return;
+    b->setStart(bc.start);
+    b->setColorOrder(bc.colorOrder);
+    b->reversed = bc.reversed;
+    b->splitGroup = bc.splitGroup;
+  }
+
+  //re-creates only the busses whose type, pins or length changed, unchanged busses keep running.
+  //configs is a nullptr terminated list of at most WLED_MAX_BUSSES. Call resetAdmission() first.
+  //Returns the number of (re-)created busses.
+  //do not call this method from system context (network callback)
+  uint8_t reconfigure(BusConfig** configs) {
+    uint8_t numConfigs = 0;
+    while (numConfigs < WLED_MAX_BUSSES && configs[numConfigs] != nullptr) numConfigs++;
+
+    //prevents crashes due to deleting busses while in use.
+    while (!canAllShow()) yield();
+
+    Bus* prev[WLED_MAX_BUSSES] = {nullptr};
+    uint8_t numPrev = numBusses;
+    for (uint8_t i = 0; i < numPrev; i++) prev[i] = busses[i];
+    numBusses = 0;
+
+    //free changed or removed busses first, so their memory and pins are available to the new ones
+    for (uint8_t i = 0; i < numPrev; i++) {
+      if (i < numConfigs && !needsRebuild(prev[i], *configs[i])) continue;
+      delete prev[i]; prev[i] = nullptr;
+    }
+
+    uint8_t created = 0;
+    for (uint8_t i = 0; i < numConfigs; i++) {
+      BusConfig &bc = *configs[i];
+      //an unchanged bus can only be kept at its old index, on ESP32 the index determines the RMT channel
+      if (i < numPrev && prev[i] != nullptr) {
+        if (numBusses == i) {
+          if (admit(bc, prev[i]->getMemUsage(), true)) {
+            updateInPlace(prev[i], bc);
+            busses[numBusses++] = prev[i];
+            prev[i] = nullptr;
+          } else {
+            delete prev[i]; prev[i] = nullptr;
+          }
+          continue;
+        }
+        delete prev[i]; prev[i] = nullptr;
+      }
+      if (add(bc) >= 0) created++;
+    }
+
+    for (uint8_t i = 0; i < numPrev; i++) {
+      if (prev[i] != nullptr) delete prev[i];
+    }
+    return created;
+  }
+
   //do not call this method from system context (network callback)
   void removeAll() {
     //Serial.println("Removing all.");
@@ -348,10 +604,21 @@ class BusManager {
 
   void show() {
     for (uint8_t i = 0; i < numBusses; i++) {
-      busses[i]->show();
+      if (timingEnabled) busses[i]->showTimed();
+      else               busses[i]->show();
     }
   }
 
+  //call often (every loop) so the time a bus stays busy after show() is measured accurately
+  void probeTiming() {
+    if (!timingEnabled) return;
+    for (uint8_t i = 0; i < numBusses; i++) busses[i]->probeBusy();
+  }
+
+  void resetTiming() {
+    for (uint8_t i = 0; i < numBusses; i++) busses[i]->timing.reset();
+  }
+
   void setPixelColor(uint16_t pix, uint32_t c) {
     for (uint8_t i = 0; i < numBusses; i++) {
       Bus* b = busses[i];
@@ -393,6 +660,8 @@ class BusManager {
     return numBusses;
   }
 
+  bool timingEnabled = false; //optional probe, hw.led.perf or /json/perf?on=1
+
   static bool isRgbw(uint8_t type) {
     if (type == TYPE_SK6812_RGBW || type == TYPE_TM1814) return true;
     if (type > TYPE_ONOFF && type <= TYPE_ANALOG_5CH && type != TYPE_ANALOG_3CH) return true;
@@ -402,5 +671,11 @@ class BusManager {
   private:
   uint8_t numBusses = 0;
   Bus* busses[WLED_MAX_BUSSES];
+
+  uint32_t _memReserve = 0;
+  uint32_t _memAdmitted = 0;
+  uint8_t _numConfigs = 0;
+  uint8_t _numRejected = 0;
+  BusRejection _rejected[WLED_MAX_BUSSES];
 };
 #endif
\ No newline at end of file
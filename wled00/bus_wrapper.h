@@ -11,6 +11,11 @@
 #define P_32_VS_MOSI   23
 #define P_32_VS_CLK    18
 
+//assumed clock rates for the theoretical wire time of a bus
+#define BUS_HW_SPI_KHZ 10000 //NeoPixelBus default for hardware SPI methods
+#define BUS_SW_SPI_KHZ  1000 //bit-banged SPI, depends on CPU speed
+#define BUS_LATCH_US      50 //reset time of clockless (WS281x) chips
+
 //The dirty list of possible bus types. Quite a lot...
 #define I_NONE 0
 //ESP8266 RGB
@@ -493,6 +498,144 @@ class PolyBus {
     }
     return true;
   };
+
+  //bytes of the pixel buffer plus the buffers allocated by the output driver (ESP8266 DMA, ESP32 RMT/I2S)
+  static uint32_t getDataSize(void* busPtr, uint8_t busType) {
+    if (busPtr == nullptr) return 0;
+    uint32_t size = 0;
+    switch (busType) {
+      case I_NONE: break;
+    #ifdef ESP8266
+      case I_8266_U0_NEO_3: size = (static_cast<B_8266_U0_NEO_3*>(busPtr))->PixelsSize(); break;
+      case I_8266_U1_NEO_3: size = (static_cast<B_8266_U1_NEO_3*>(busPtr))->PixelsSize(); break;
+      case I_8266_DM_NEO_3: size = (static_cast<B_8266_DM_NEO_3*>(busPtr))->PixelsSize(); break;
+      case I_8266_BB_NEO_3: size = (static_cast<B_8266_BB_NEO_3*>(busPtr))->PixelsSize(); break;
+      case I_8266_U0_NEO_4: size = (static_cast<B_8266_U0_NEO_4*>(busPtr))->PixelsSize(); break;
+      case I_8266_U1_NEO_4: size = (static_cast<B_8266_U1_NEO_4*>(busPtr))->PixelsSize(); break;
+      case I_8266_DM_NEO_4: size = (static_cast<B_8266_DM_NEO_4*>(busPtr))->PixelsSize(); break;
+      case I_8266_BB_NEO_4: size = (static_cast<B_8266_BB_NEO_4*>(busPtr))->PixelsSize(); break;
+      case I_8266_U0_400_3: size = (static_cast<B_8266_U0_400_3*>(busPtr))->PixelsSize(); break;
+      case I_8266_U1_400_3: size = (static_cast<B_8266_U1_400_3*>(busPtr))->PixelsSize(); break;
+      case I_8266_DM_400_3: size = (static_cast<B_8266_DM_400_3*>(busPtr))->PixelsSize(); break;
+      case I_8266_BB_400_3: size = (static_cast<B_8266_BB_400_3*>(busPtr))->PixelsSize(); break;
+      case I_8266_U0_TM1_4: size = (static_cast<B_8266_U0_TM1_4*>(busPtr))->PixelsSize(); break;
+      case I_8266_U1_TM1_4: size = (static_cast<B_8266_U1_TM1_4*>(busPtr))->PixelsSize(); break;
+      case I_8266_DM_TM1_4: size = (static_cast<B_8266_DM_TM1_4*>(busPtr))->PixelsSize(); break;
+      case I_8266_BB_TM1_4: size = (static_cast<B_8266_BB_TM1_4*>(busPtr))->PixelsSize(); break;
+    #endif
+    #ifdef ARDUINO_ARCH_ESP32
+      case I_32_R0_NEO_3: size = (static_cast<B_32_R0_NEO_3*>(busPtr))->PixelsSize(); break;
+      case I_32_R1_NEO_3: size = (static_cast<B_32_R1_NEO_3*>(busPtr))->PixelsSize(); break;
+      case I_32_R2_NEO_3: size = (static_cast<B_32_R2_NEO_3*>(busPtr))->PixelsSize(); break;
+      case I_32_R3_NEO_3: size = (static_cast<B_32_R3_NEO_3*>(busPtr))->PixelsSize(); break;
+      case I_32_R4_NEO_3: size = (static_cast<B_32_R4_NEO_3*>(busPtr))->PixelsSize(); break;
+      case I_32_R5_NEO_3: size = (static_cast<B_32_R5_NEO_3*>(busPtr))->PixelsSize(); break;
+      case I_32_R6_NEO_3: size = (static_cast<B_32_R6_NEO_3*>(busPtr))->PixelsSize(); break;
+      case I_32_R7_NEO_3: size = (static_cast<B_32_R7_NEO_3*>(busPtr))->PixelsSize(); break;
+      case I_32_I0_NEO_3: size = (static_cast<B_32_I0_NEO_3*>(busPtr))->PixelsSize(); break;
+      case I_32_I1_NEO_3: size = (static_cast<B_32_I1_NEO_3*>(busPtr))->PixelsSize(); break;
+      case I_32_R0_NEO_4: size = (static_cast<B_32_R0_NEO_4*>(busPtr))->PixelsSize(); break;
+      case I_32_R1_NEO_4: size = (static_cast<B_32_R1_NEO_4*>(busPtr))->PixelsSize(); break;
+      case I_32_R2_NEO_4: size = (static_cast<B_32_R2_NEO_4*>(busPtr))->PixelsSize(); break;
+      case I_32_R3_NEO_4: size = (static_cast<B_32_R3_NEO_4*>(busPtr))->PixelsSize(); break;
+      case I_32_R4_NEO_4: size = (static_cast<B_32_R4_NEO_4*>(busPtr))->PixelsSize(); break;
+      case I_32_R5_NEO_4: size = (static_cast<B_32_R5_NEO_4*>(busPtr))->PixelsSize(); break;
+      case I_32_R6_NEO_4: size = (static_cast<B_32_R6_NEO_4*>(busPtr))->PixelsSize(); break;
+      case I_32_R7_NEO_4: size = (static_cast<B_32_R7_NEO_4*>(busPtr))->PixelsSize(); break;
+      case I_32_I0_NEO_4: size = (static_cast<B_32_I0_NEO_4*>(busPtr))->PixelsSize(); break;
+      case I_32_I1_NEO_4: size = (static_cast<B_32_I1_NEO_4*>(busPtr))->PixelsSize(); break;
+      case I_32_R0_400_3: size = (static_cast<B_32_R0_400_3*>(busPtr))->PixelsSize(); break;
+      case I_32_R1_400_3: size = (static_cast<B_32_R1_400_3*>(busPtr))->PixelsSize(); break;
+      case I_32_R2_400_3: size = (static_cast<B_32_R2_400_3*>(busPtr))->PixelsSize(); break;
+      case I_32_R3_400_3: size = (static_cast<B_32_R3_400_3*>(busPtr))->PixelsSize(); break;
+      case I_32_R4_400_3: size = (static_cast<B_32_R4_400_3*>(busPtr))->PixelsSize(); break;
+      case I_32_R5_400_3: size = (static_cast<B_32_R5_400_3*>(busPtr))->PixelsSize(); break;
+      case I_32_R6_400_3: size = (static_cast<B_32_R6_400_3*>(busPtr))->PixelsSize(); break;
+      case I_32_R7_400_3: size = (static_cast<B_32_R7_400_3*>(busPtr))->PixelsSize(); break;
+      case I_32_I0_400_3: size = (static_cast<B_32_I0_400_3*>(busPtr))->PixelsSize(); break;
+      case I_32_I1_400_3: size = (static_cast<B_32_I1_400_3*>(busPtr))->PixelsSize(); break;
+      case I_32_R0_TM1_4: size = (static_cast<B_32_R0_TM1_4*>(busPtr))->PixelsSize(); break;
+      case I_32_R1_TM1_4: size = (static_cast<B_32_R1_TM1_4*>(busPtr))->PixelsSize(); break;
+      case I_32_R2_TM1_4: size = (static_cast<B_32_R2_TM1_4*>(busPtr))->PixelsSize(); break;
+      case I_32_R3_TM1_4: size = (static_cast<B_32_R3_TM1_4*>(busPtr))->PixelsSize(); break;
+      case I_32_R4_TM1_4: size = (static_cast<B_32_R4_TM1_4*>(busPtr))->PixelsSize(); break;
+      case I_32_R5_TM1_4: size = (static_cast<B_32_R5_TM1_4*>(busPtr))->PixelsSize(); break;
+      case I_32_R6_TM1_4: size = (static_cast<B_32_R6_TM1_4*>(busPtr))->PixelsSize(); break;
+      case I_32_R7_TM1_4: size = (static_cast<B_32_R7_TM1_4*>(busPtr))->PixelsSize(); break;
+      case I_32_I0_TM1_4: size = (static_cast<B_32_I0_TM1_4*>(busPtr))->PixelsSize(); break;
+      case I_32_I1_TM1_4: size = (static_cast<B_32_I1_TM1_4*>(busPtr))->PixelsSize(); break;
+    #endif
+      case I_HS_DOT_3: size = (static_cast<B_HS_DOT_3*>(busPtr))->PixelsSize(); break;
+      case I_SS_DOT_3: size = (static_cast<B_SS_DOT_3*>(busPtr))->PixelsSize(); break;
+      case I_HS_LPD_3: size = (static_cast<B_HS_LPD_3*>(busPtr))->PixelsSize(); break;
+      case I_SS_LPD_3: size = (static_cast<B_SS_LPD_3*>(busPtr))->PixelsSize(); break;
+      case I_HS_WS1_3: size = (static_cast<B_HS_WS1_3*>(busPtr))->PixelsSize(); break;
+      case I_SS_WS1_3: size = (static_cast<B_SS_WS1_3*>(busPtr))->PixelsSize(); break;
+      case I_HS_P98_3: size = (static_cast<B_HS_P98_3*>(busPtr))->PixelsSize(); break;
+      case I_SS_P98_3: size = (static_cast<B_SS_P98_3*>(busPtr))->PixelsSize(); break;
+    }
+    return size * getBufferFactor(busType);
+  }
+
+  //estimate of getDataSize() before the bus is created
+  static uint32_t getDataSize(uint8_t busType, uint16_t len) {
+    if (busType == I_NONE) return 0;
+    return len * getBytesPerPixel(busType) * getBufferFactor(busType);
+  }
+
+  //size of the driver buffers in multiples of the pixel buffer
+  static uint8_t getBufferFactor(uint8_t busType) {
+    #ifdef ESP8266
+    //DMA (gpio3) encodes every data byte into 4 bytes of I2S buffer
+    if (busType == I_8266_DM_NEO_3 || busType == I_8266_DM_NEO_4 || busType == I_8266_DM_400_3 || busType == I_8266_DM_TM1_4) return 5;
+    #endif
+    #ifdef ARDUINO_ARCH_ESP32
+    if (busType >= I_32_R0_NEO_3 && busType <= I_32_I1_TM1_4) {
+      if ((busType - I_32_R0_NEO_3) % 10 > 7) return 5; //I2S, same encoding as ESP8266 DMA
+      return 2; //RMT keeps an editing and a sending buffer
+    }
+    #endif
+    return 1;
+  }
+
+  //true if the driver sends in the background, so several such busses transmit in parallel
+  static bool isAsync(uint8_t busType) {
+    #ifdef ESP8266
+    return (busType == I_8266_DM_NEO_3 || busType == I_8266_DM_NEO_4 || busType == I_8266_DM_400_3 || busType == I_8266_DM_TM1_4);
+    #else
+    return (busType >= I_32_R0_NEO_3 && busType <= I_32_I1_TM1_4);
+    #endif
+  }
+
+  //theoretical time in us to send len pixels, including the latch/reset time
+  static uint32_t getWireTime(uint8_t busType, uint16_t len) {
+    if (busType == I_NONE) return 0;
+    uint32_t bits = (uint32_t)len * getBytesPerPixel(busType) * 8;
+    if (busType >= I_HS_DOT_3) { //SPI, start/end frames and latch are roughly 64 clocks
+      uint32_t khz = (busType % 2) ? BUS_HW_SPI_KHZ : BUS_SW_SPI_KHZ; //hardware SPI types are odd
+      return ((bits + 64) * 1000) / khz;
+    }
+    uint32_t nsPerBit = 1250; //800kHz
+    #ifdef ESP8266
+    if (busType >= I_8266_U0_400_3 && busType <= I_8266_BB_400_3) nsPerBit = 2500;
+    #else
+    if (busType >= I_32_R0_400_3 && busType <= I_32_I1_400_3) nsPerBit = 2500;
+    #endif
+    return (bits * nsPerBit) / 1000 + BUS_LATCH_US;
+  }
+
+  static uint8_t getBytesPerPixel(uint8_t busType) {
+    switch (busType) {
+      case I_8266_U0_NEO_4: case I_8266_U1_NEO_4: case I_8266_DM_NEO_4: case I_8266_BB_NEO_4:
+      case I_8266_U0_TM1_4: case I_8266_U1_TM1_4: case I_8266_DM_TM1_4: case I_8266_BB_TM1_4:
+      case I_HS_DOT_3: case I_SS_DOT_3: case I_HS_P98_3: case I_SS_P98_3: //header byte per LED
+        return 4;
+    }
+    if (busType >= I_32_R0_NEO_4 && busType <= I_32_I1_NEO_4) return 4;
+    if (busType >= I_32_R0_TM1_4 && busType <= I_32_I1_TM1_4) return 4;
+    return 3;
+  }
+
   static void setPixelColor(void* busPtr, uint8_t busType, uint16_t pix, uint32_t c, uint8_t co) {
     uint8_t r = c >> 16;
     uint8_t g = c >> 8;
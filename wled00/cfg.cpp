@@ -96,12 +96,13 @@ void deserializeConfig() {
   CJSON(strip.ablMilliampsMax, hw_led[F("maxpwr")]);
   CJSON(strip.milliampsPerLed, hw_led[F("ledma")]);
   CJSON(strip.rgbwMode, hw_led[F("rgbwm")]);
+  CJSON(busses.timingEnabled, hw_led[F("perf")]);
 
   JsonArray ins = hw_led["ins"];
   uint8_t s = 0; //bus iterator
   strip.isRgbw = false;
   busses.removeAll();
-  uint32_t mem = 0;
+  busses.resetAdmission(strip.getBusMemReserve(true)); //the config document is still allocated
   for (JsonObject elm : ins) {
     if (s >= WLED_MAX_BUSSES) break;
     uint8_t pins[5] = {255, 255, 255, 255, 255};
@@ -130,11 +131,24 @@ void deserializeConfig() {
     strip.isRgbw = (strip.isRgbw || BusManager::isRgbw(ledType));
     s++;
     BusConfig bc = BusConfig(ledType, pins, start, length, colorOrder, reversed);
-    mem += busses.memUsage(bc);
-    if (mem <= MAX_LED_MEMORY) busses.add(bc);
+    //optional additional data pins, the range is then split into one output per pin
+    JsonArray splitArr = elm[F("split")];
+    if (splitArr.size() > 0) {
+      uint8_t splitPins[WLED_MAX_BUSSES] = {pins[0]};
+      uint8_t numSplit = 1;
+      for (int p : splitArr) {
+        if (numSplit >= WLED_MAX_BUSSES) break;
+        splitPins[numSplit++] = p;
+      }
+      busses.addSplit(bc, splitPins, numSplit, s);
+      continue;
+    }
+    if (busses.add(bc) < 0) {
+      DEBUG_PRINT(F("Bus rejected, needs bytes: ")); DEBUG_PRINTLN(busses.memUsage(bc));
+    }
   }
   strip.finalizeInit(ledCount, skipFirstLed);
-  if (hw_led["rev"]) busses.getBus(0)->reversed = true; //set 0.11 global reversed setting for first bus
+  if (hw_led["rev"] && busses.getBus(0)) busses.getBus(0)->reversed = true; //set 0.11 global reversed setting for first bus
 
   JsonObject hw_btn_ins_0 = hw[F("btn")][F("ins")][0];
   CJSON(buttonType, hw_btn_ins_0["type"]);
@@ -178,6 +192,13 @@ void deserializeConfig() {
 
   //int hw_status_pin = hw[F("status")][F("pin")]; // -1
 
+  CJSON(serialBaud, hw[F("baud")]);
+  if (serialBaud < 96 || serialBaud > WLED_SERIAL_BAUD_MAX) serialBaud = 1152;
+  if (serialBaud != 1152) {
+    Serial.flush();
+    Serial.updateBaudRate(serialBaud * 100);
+  }
+
   JsonObject light = doc[F("light")];
   CJSON(briMultiplier, light[F("scale-bri")]);
   CJSON(strip.paletteBlend, light[F("pal-mode")]);
@@ -222,6 +243,9 @@ void deserializeConfig() {
   JsonObject if_sync = interfaces[F("sync")];
   CJSON(udpPort, if_sync[F("port0")]); // 21324
   CJSON(udpPort2, if_sync[F("port1")]); // 65506
+  CJSON(timeSyncEnabled, if_sync[F("ts")]);
+  CJSON(strip.framePeriod, if_sync[F("fgrid")]);
+  if (strip.framePeriod && strip.framePeriod < MIN_SHOW_DELAY) strip.framePeriod = MIN_SHOW_DELAY;
 
   JsonObject if_sync_recv = if_sync["recv"];
   CJSON(receiveNotificationBrightness, if_sync_recv["bri"]);
@@ -237,11 +261,15 @@ void deserializeConfig() {
   CJSON(notifyHue, if_sync_send[F("hue")]);
   CJSON(notifyMacro, if_sync_send[F("macro")]);
   CJSON(notifyTwice, if_sync_send[F("twice")]);
+  CJSON(notifySegments, if_sync_send[F("seg")]);
 
   JsonObject if_nodes = interfaces["nodes"];
   CJSON(nodeListEnabled, if_nodes[F("list")]);
   CJSON(nodeBroadcastEnabled, if_nodes[F("bcast")]);
 
+  CJSON(wsMaxMessage, interfaces["ws"][F("max")]);
+  if (wsMaxMessage > JSON_BUFFER_SIZE) wsMaxMessage = JSON_BUFFER_SIZE;
+
   JsonObject if_live = interfaces["live"];
   CJSON(receiveDirect, if_live["en"]);
   CJSON(e131Port, if_live["port"]); // 5568
@@ -258,6 +286,8 @@ void deserializeConfig() {
   CJSON(arlsForceMaxBri, if_live[F("maxbri")]);
   CJSON(arlsDisableGammaCorrection, if_live[F("no-gc")]); // false
   CJSON(arlsOffset, if_live[F("offset")]); // 0
+  CJSON(realtimeBufferDepth, if_live[F("buf")]); // 0
+  if (realtimeBufferDepth > REALTIME_BUFFER_MAX) realtimeBufferDepth = REALTIME_BUFFER_MAX;
 
   CJSON(alexaEnabled, interfaces[F("va")][F("alexa")]); // false
 
@@ -451,6 +481,7 @@ void serializeConfig() {
   hw_led[F("maxpwr")] = strip.ablMilliampsMax;
   hw_led[F("ledma")] = strip.milliampsPerLed;
   hw_led[F("rgbwm")] = strip.rgbwMode;
+  hw_led[F("perf")] = busses.timingEnabled;
 
   JsonArray hw_led_ins = hw_led.createNestedArray("ins");
 
@@ -460,14 +491,37 @@ void serializeConfig() {
     JsonObject ins = hw_led_ins.createNestedObject();
     ins["en"] = true;
     ins[F("start")] = bus->getStart();
-    ins[F("len")] = bus->getLength();
-    JsonArray ins_pin = ins.createNestedArray("pin");
+    uint32_t len = bus->getLength();
     uint8_t pins[5];
     uint8_t nPins = bus->getPins(pins);
+
+    //the parts of a split range that are still contiguous are saved as one entry again
+    uint8_t splitPins[WLED_MAX_BUSSES] = {pins[0]};
+    uint8_t numSplit = 1;
+    while (bus->splitGroup && s + 1 < busses.getNumBusses()) {
+      Bus *part = busses.getBus(s + 1);
+      if (part->splitGroup != bus->splitGroup || part->getType() != bus->getType() || part->reversed != bus->reversed
+        || part->getColorOrder() != bus->getColorOrder() || part->getStart() != bus->getStart() + len) break;
+      uint8_t partPins[5];
+      part->getPins(partPins);
+      splitPins[numSplit++] = partPins[0];
+      len += part->getLength();
+      s++;
+    }
+    if (numSplit > 1) { //pins in wiring order, see BusManager::addSplit()
+      if (bus->reversed) for (uint8_t i = 0; i < numSplit/2; i++) {
+        uint8_t t = splitPins[i]; splitPins[i] = splitPins[numSplit -1 -i]; splitPins[numSplit -1 -i] = t;
+      }
+      pins[0] = splitPins[0];
+      JsonArray ins_split = ins.createNestedArray(F("split"));
+      for (uint8_t i = 1; i < numSplit; i++) ins_split.add(splitPins[i]);
+    }
+    JsonArray ins_pin = ins.createNestedArray("pin");
     for (uint8_t i = 0; i < nPins; i++) ins_pin.add(pins[i]);
+    ins[F("len")] = len;
     ins[F("order")] = bus->getColorOrder();
     ins["rev"] = bus->reversed;
-    ins[F("skip")] = (skipFirstLed && s == 0) ? 1 : 0;
+    ins[F("skip")] = (skipFirstLed && bus == busses.getBus(0)) ? 1 : 0;
     ins["type"] = bus->getType();
   }
 
@@ -497,6 +551,8 @@ void serializeConfig() {
   hw_relay["pin"] = rlyPin;
   hw_relay["rev"] = !rlyMde;
 
+  hw[F("baud")] = serialBaud;
+
   //JsonObject hw_status = hw.createNestedObject("status");
   //hw_status["pin"] = -1;
 
@@ -540,6 +596,8 @@ void serializeConfig() {
   JsonObject if_sync = interfaces.createNestedObject("sync");
   if_sync[F("port0")] = udpPort;
   if_sync[F("port1")] = udpPort2;
+  if_sync[F("ts")] = timeSyncEnabled;
+  if_sync[F("fgrid")] = strip.framePeriod;
 
   JsonObject if_sync_recv = if_sync.createNestedObject("recv");
   if_sync_recv["bri"] = receiveNotificationBrightness;
@@ -553,11 +611,15 @@ void serializeConfig() {
   if_sync_send[F("hue")] = notifyHue;
   if_sync_send[F("macro")] = notifyMacro;
   if_sync_send[F("twice")] = notifyTwice;
+  if_sync_send[F("seg")] = notifySegments;
 
   JsonObject if_nodes = interfaces.createNestedObject("nodes");
   if_nodes[F("list")] = nodeListEnabled;
   if_nodes[F("bcast")] = nodeBroadcastEnabled;
 
+  JsonObject if_ws = interfaces.createNestedObject("ws");
+  if_ws[F("max")] = wsMaxMessage;
+
   JsonObject if_live = interfaces.createNestedObject("live");
   if_live["en"] = receiveDirect;
   if_live["port"] = e131Port;
@@ -572,6 +634,7 @@ void serializeConfig() {
   if_live[F("maxbri")] = arlsForceMaxBri;
   if_live[F("no-gc")] = arlsDisableGammaCorrection;
   if_live[F("offset")] = arlsOffset;
+  if_live[F("buf")] = realtimeBufferDepth;
 
   JsonObject if_va = interfaces.createNestedObject("va");
   if_va[F("alexa")] = alexaEnabled;
@@ -186,6 +186,30 @@
 
 #define NTP_PACKET_SIZE 48
 
+//max. packets and time (us) handleNotifications() spends draining the UDP sockets per loop
+#ifndef UDP_DRAIN_MAX_PACKETS
+#ifdef ESP8266
+#define UDP_DRAIN_MAX_PACKETS 8
+#else
+#define UDP_DRAIN_MAX_PACKETS 16
+#endif
+#endif
+#ifndef UDP_DRAIN_MAX_US
+#define UDP_DRAIN_MAX_US 3000
+#endif
+
+//max. serial baud rate / 100
+#ifndef WLED_SERIAL_BAUD_MAX
+#ifdef ESP8266
+#define WLED_SERIAL_BAUD_MAX 30000
+#else
+#define WLED_SERIAL_BAUD_MAX 50000
+#endif
+#endif
+
+//max. realtime frames held back by the jitter buffer
+#define REALTIME_BUFFER_MAX 3
+
 // maximum number of LEDs - more than 1500 LEDs (or 500 DMA "LEDPIN 3" driven ones) will cause a low memory condition on ESP8266
 #ifndef MAX_LEDS
 #ifdef ESP8266
@@ -203,6 +227,21 @@
 #endif
 #endif
 
+//heap kept free for WiFi, web server and other allocations when admitting busses (on top of segment data and JSON buffers)
+#ifndef WLED_HEAP_RESERVE
+#ifdef ESP8266
+#define WLED_HEAP_RESERVE 6144
+#else
+#define WLED_HEAP_RESERVE 16384
+#endif
+#endif
+
+//reasons for a bus config to be rejected (reported in info.leds.rej)
+#define BUS_REJECT_NONE    0
+#define BUS_REJECT_COUNT   1 // more than WLED_MAX_BUSSES busses
+#define BUS_REJECT_MAXMEM  2 // the bus would exceed MAX_LED_MEMORY
+#define BUS_REJECT_HEAP    3 // not enough free heap left for segment data, LED map and JSON buffers
+
 #ifndef MAX_LEDS_PER_BUS
 #define MAX_LEDS_PER_BUS 4096
 #endif
@@ -210,7 +249,19 @@
 // string temp buffer (now stored in stack locally)
 #define OMAX 2048
 
-#define E131_MAX_UNIVERSE_COUNT 9
+#define E131_FRAME_TIMEOUT    40   // ms after the first universe of a frame until it is shown even if incomplete
+#define E131_UNIVERSE_TIMEOUT 1000 // ms without packets until a universe is no longer expected in frames
+#define E131_SYNC_TIMEOUT     3000 // ms without sync packets until frames are shown when complete again
+#define DDP_TIMECODE_LATENCY  20   // ms a DDP frame with timecode is held back to even out network jitter
+#define DDP_SEQ_SLACK         2    // lost DDP packets tolerated before a sequence number counts as late
+#define DDP_TIMECODE_WRAP     65536000UL // ms until the 16 bit seconds of a DDP timecode wrap
+
+#define TIMESYNC_INTERVAL      1000 // ms between clock sync requests to the reference node
+#define TIMESYNC_SAMPLES          8 // clock sync samples kept, the one with the lowest round trip time is used
+#define TIMESYNC_MIN_SAMPLES      3 // samples until the coarse timebase of notifications is ignored
+#define TIMESYNC_MAX_RTT        200 // ms, slower clock sync responses are dropped
+#define TIMESYNC_STEP           500 // ms, larger offsets are applied at once instead of slewed
+#define TIMESYNC_SLEW_INTERVAL  100 // ms between 1ms adjustments of the timebase
 
 #define ABL_MILLIAMPS_DEFAULT 850  // auto lower brightness to stay close to milliampere limit
 
@@ -232,6 +283,34 @@
   #define JSON_BUFFER_SIZE 16384
 #endif
 
+// HTTP API parameters parsed per request (handleSet)
+#define API_PARAM_SLOTS_BITS 6
+#define API_PARAM_SLOTS (1 << API_PARAM_SLOTS_BITS)
+#define API_PARAM_MAX   48 // further parameters are ignored, keeps the hash table sparse
+
+// Binary segment pixel update (/pixels and websocket binary messages)
+// 0: segment id, 1: flags, 2-3: first LED in the segment (BE), 4-: R,G,B(,W) bytes
+#define PIXEL_SET_HEADER_LEN 4
+#define PIXEL_SET_RGBW       0x01  // 4 bytes per pixel
+#define PIXEL_SET_MAX_LEN    16384 // same limit as JSON bodies (AsyncCallbackJsonWebHandler)
+
+// Max. size of a websocket message split into several frames or packets (if.ws.max)
+#ifdef ESP8266
+  #define WS_MAX_MESSAGE 4096
+#else
+  #define WS_MAX_MESSAGE 8192
+#endif
+
+// Size of the documents /json is streamed from, one section (state, segment or info) at a time
+#define JSON_STREAM_SEG_SIZE 1024
+#define JSON_STREAM_MAX_PIECES (MAX_NUM_SEGMENTS +8)
+#define STATE_SNAPSHOT_MAX_AGE 1000 // ms, the serialized state is refreshed at least this often (e.g. nightlight remaining time)
+#ifdef ESP8266
+  #define JSON_STREAM_INFO_SIZE 4096
+#else
+  #define JSON_STREAM_INFO_SIZE 6144
+#endif
+
 // Maximum size of node map (list of other WLED instances)
 #ifdef ESP8266
   #define WLED_MAX_NODES 15
@@ -0,0 +1,115 @@
+#ifndef WLED_DDP_HOLD_H
+#define WLED_DDP_HOLD_H
+
+/*
+ * Holds a DDP frame with timecode in the pixel buffer until it is due, used by e131.cpp.
+ * All DDP pixel data is also copied into a buffer indexed like the packets (the incoming frame).
+ * While a frame is held, the next one is only written to that copy and reaches the pixel buffer after the held one was shown.
+ * There is no locking in here, the callers hold NET_LOCK() around each call.
+ */
+
+#include <Arduino.h>
+
+class DdpFrameHold {
+  public:
+    uint32_t skipped = 0;   //held frames dropped because the sender was two frames ahead
+
+    bool attached() { return _buf; }
+    uint16_t leds() { return _leds; }
+    uint8_t bpp() { return _bpp; }
+
+    //buf holds leds * bpp bytes, allocated by the caller (not in the network callback)
+    void attach(byte* buf, uint16_t leds, uint8_t bpp) {
+      _buf = buf; _leds = leds; _bpp = bpp;
+      _pushAt = 0; _nextAt = 0; _busy = false;
+      _lo = leds; _hi = 0;
+    }
+
+    //returns the buffer to free once no network callback uses it anymore, held is set if a frame was waiting
+    byte* detach(bool &held) {
+      byte* buf = _buf;
+      held = _pushAt;
+      _buf = nullptr;
+      _pushAt = 0; _nextAt = 0; _busy = false;
+      return buf;
+    }
+
+    //network callback: pixels of the frame being received, true if they go to the pixel buffer as well (no frame held)
+    bool write(uint16_t start, const byte* data, uint16_t count, uint8_t stride) {
+      if (!_buf) return true;
+      if (start >= _leds) return !_pushAt;
+      if (start + count > _leds) count = _leds - start;
+      byte* dst = _buf + start * _bpp;
+      if (stride == _bpp) memcpy(dst, data, count * _bpp);
+      else {
+        for (uint16_t i = 0; i < count; i++, data += stride, dst += _bpp) {
+          dst[0] = data[0]; dst[1] = data[1]; dst[2] = data[2];
+          if (_bpp > 3) dst[3] = (stride > 3) ? data[3] : 0;
+        }
+      }
+      if (!_pushAt) return true;
+      if (start < _lo) _lo = start;
+      if (start + count > _hi) _hi = start + count;
+      return false;
+    }
+
+    //network callback: the frame being received is complete and due in wait ms, true if it is to be shown right away.
+    //Without the copy frames cannot wait, they are shown when they arrive
+    bool push(uint32_t now, uint32_t wait) {
+      if (!_buf) return true;
+      if (!_pushAt) {
+        if (!wait) return true;
+        _pushAt = (now + wait) | 1; //0 means no frame held
+        return false;
+      }
+      _nextAt = (now + wait) | 1;
+      return false;
+    }
+
+    //network callback: true if the next frame starts while one is held and the one after it is complete.
+    //The held frame is dropped, the caller writes the complete one to the pixel buffer with take() and calls done()
+    bool skip() {
+      if (!_pushAt || !_nextAt || _busy) return false;
+      skipped++;
+      _busy = true;
+      return true;
+    }
+
+    //loop(): true if the held frame is due, the caller shows it, writes the next one to the pixel buffer with take() and calls done()
+    bool due(uint32_t now) {
+      if (!_pushAt || _busy || (int32_t)(now - _pushAt) < 0) return false;
+      _busy = true;
+      return true;
+    }
+
+    //pixels received since the held frame, nullptr once all were taken. More may arrive until done() is called
+    const byte* take(uint16_t &start, uint16_t &count) {
+      if (_lo >= _hi) return nullptr;
+      start = _lo; count = _hi - _lo;
+      _lo = _leds; _hi = 0;
+      return _buf + start * _bpp;
+    }
+
+    //the held frame was shown or dropped, true if the next one is complete and due now
+    bool done(uint32_t now) {
+      _busy = false;
+      _pushAt = 0;
+      if (!_nextAt) return false;
+      uint32_t at = _nextAt;
+      _nextAt = 0;
+      if ((int32_t)(now - at) >= 0) return true;
+      _pushAt = at;
+      return false;
+    }
+
+  private:
+    byte* _buf = nullptr;
+    uint16_t _leds = 0;
+    uint8_t _bpp = 3;
+    uint32_t _pushAt = 0;   //millis() the frame in the pixel buffer is due, 0 = none held
+    uint32_t _nextAt = 0;   //the frame received meanwhile is complete and due then, 0 = not complete
+    bool _busy = false;     //the held frame is being shown or dropped
+    uint16_t _lo = 0, _hi = 0; //pixels received while the frame was held
+};
+
+#endif
@@ -8,52 +8,360 @@
  * E1.31 handler
  */
 
+//number of universes needed for all LEDs in the current DMX mode, starting at e131Universe
+static uint16_t e131UniversesNeeded() {
+  if (DMXMode < DMX_MODE_MULTIPLE_RGB) return 1;
+  bool is4Chan = (DMXMode == DMX_MODE_MULTIPLE_RGBW);
+  uint16_t dmxChannelsPerLed = is4Chan ? 4 : 3;
+  uint16_t ledsPerUniverse = is4Chan ? MAX_4_CH_LEDS_PER_UNIVERSE : MAX_3_CH_LEDS_PER_UNIVERSE;
+  uint16_t ledsInFirstUniverse = (MAX_CHANNELS_PER_UNIVERSE - DMXAddress) / dmxChannelsPerLed;
+  uint16_t count = 1;
+  if (ledCount > ledsInFirstUniverse) count += (ledCount - ledsInFirstUniverse + ledsPerUniverse -1) / ledsPerUniverse;
+  return count;
+}
+
+//(re)allocates the universe state for the configured LED count and DMX mode and precomputes the first LED of each universe.
+//Call from loop() after changing ledCount, DMXMode, DMXAddress or e131Universe (set doInitE131 in network callbacks)
+void initE131Universes() {
+  uint16_t count = e131UniversesNeeded();
+  if (count > 255) count = 255;
+
+  E131Universe* universes = new (std::nothrow) E131Universe[count];
+  if (universes == nullptr) count = 0;
+
+  bool is4Chan = (DMXMode == DMX_MODE_MULTIPLE_RGBW);
+  uint16_t dmxChannelsPerLed = is4Chan ? 4 : 3;
+  uint16_t ledsPerUniverse = is4Chan ? MAX_4_CH_LEDS_PER_UNIVERSE : MAX_3_CH_LEDS_PER_UNIVERSE;
+  uint16_t ledsInFirstUniverse = (MAX_CHANNELS_PER_UNIVERSE - DMXAddress) / dmxChannelsPerLed;
+  for (uint16_t u = 0; u < count; u++) {
+    universes[u].ledOffset = u ? ledsInFirstUniverse + (u - 1) * ledsPerUniverse : 0;
+  }
+
+  //publish the new state first, then free the old one once no packet is decoded with it anymore
+  NET_LOCK();
+  E131Universe* old = e131Universes;
+  e131Universes = universes;
+  e131NumUniverses = count;
+  e131FrameStart = 0;
+  NET_UNLOCK();
+  while (e131UniverseUsers) delay(1);
+  delete[] old;
+  DEBUG_PRINT(F("E1.31 universes: ")); DEBUG_PRINTLN(count);
+
+  //follow universe changes while connected, e131.begin() joins the groups when the interfaces are initialized
+  if (interfacesInited && count) {
+    if (e131Multicast) e131.joinMulticast(e131Universe, count);
+    else               e131.leaveMulticast();
+  }
+}
+
+//the universe state used by a network callback, keeps initE131Universes() from freeing it until released
+E131Universe* e131AcquireUniverses(uint8_t &num) {
+  NET_LOCK();
+  e131UniverseUsers++;
+  E131Universe* universes = e131Universes;
+  num = e131NumUniverses;
+  NET_UNLOCK();
+  return universes;
+}
+
+void e131ReleaseUniverses() {
+  NET_LOCK();
+  e131UniverseUsers--;
+  NET_UNLOCK();
+}
+
+//frames wait for a sync packet as long as the sender keeps sending them
+static bool e131SyncActive() {
+  return e131WaitForSync && e131LastSync && millis() - e131LastSync < E131_SYNC_TIMEOUT;
+}
+
+//a frame is complete once all universes that were received recently are part of it
+static bool e131FrameComplete() {
+  unsigned long now = millis();
+  for (uint8_t u = 0; u < e131NumUniverses; u++) {
+    E131Universe &eu = e131Universes[u];
+    if (!eu.inFrame && eu.lastRx && now - eu.lastRx < E131_UNIVERSE_TIMEOUT) return false;
+  }
+  return true;
+}
+
+static void e131FinishFrameLocked() {
+  if (!e131FrameStart) return;
+  if (!e131FrameComplete()) e131FramesIncomplete++;
+  for (uint8_t u = 0; u < e131NumUniverses; u++) e131Universes[u].inFrame = false;
+  e131FrameStart = 0;
+  e131Frames++;
+  if (e131FramesReady < 255) e131FramesReady++;
+}
+
+//ends the frame being assembled, also if universes are missing (sync packet or next frame started).
+//The frame is shown by handleE131Frame()
+void e131FinishFrame() {
+  NET_LOCK();
+  e131FinishFrameLocked();
+  NET_UNLOCK();
+}
+
+//shows each assembled frame once, call from loop()
+void handleE131Frame() {
+  NET_LOCK();
+  if (e131FrameStart && millis() - e131FrameStart > E131_FRAME_TIMEOUT) e131FinishFrameLocked(); //still missing universes
+  uint8_t ready = e131FramesReady;
+  e131FramesReady = 0;
+  NET_UNLOCK();
+  if (!ready) return;
+  //there is one pixel buffer, a frame that was finished before loop() came around was overwritten by the next one
+  e131FramesSkipped += ready -1;
+  realtimeShow();
+}
+
+//sequence gaps are counted as lost packets, late packets (going back less than half the range) are not
+static void e131CountLoss(E131Universe &eu, uint8_t seq) {
+  if (!eu.lastRx || millis() - eu.lastRx > E131_UNIVERSE_TIMEOUT) return; //stream (re)started
+  uint8_t gap = seq - (uint8_t)(eu.lastSeq +1);
+  if (gap && gap < 128) eu.lost += gap;
+}
+
 //DDP protocol support, called by handleE131Packet
-//handles RGB data only
-void handleDDPPacket(e131_packet_t* p) {
-  int lastPushSeq = e131LastSequenceNumber[0];
-  
-  //reject late packets belonging to previous frame (assuming 4 packets max. before push)
-  if (e131SkipOutOfSequence && lastPushSeq) {
-    int sn = p->sequenceNum & 0xF;
-    if (sn) {
-      if (lastPushSeq > 5) {
-        if (sn > (lastPushSeq -5) && sn < lastPushSeq) return;
-      } else {
-        if (sn > (10 + lastPushSeq) || sn < lastPushSeq) return;
-      }
+//http://www.3waylabs.com/ddp/
+
+//true if the packet belongs to a frame that was already pushed (sequence numbers are 1-15, 0 = not used).
+//The previous frame used the ddpPrevFrameSpan numbers up to its push, the frame in progress the ddpFrameSpan
+//numbers after it (plus DDP_SEQ_SLACK for lost packets). Frames longer than 15 packets are never dropped.
+static bool ddpIsLate(uint8_t sn) {
+  if (!sn || !ddpLastSequenceNumber) return false;
+  uint8_t behind = (ddpLastSequenceNumber - sn + 15) % 15; //0 = the push packet itself
+  uint8_t ahead = 15 - behind;
+  if (behind < ddpPrevFrameSpan && ahead > ddpFrameSpan + DDP_SEQ_SLACK) return true;
+  if (ahead > ddpFrameSpan && ahead < 15) ddpFrameSpan = ahead;
+  return false;
+}
+
+//ms until a frame with the given timecode (NTP format, 16.16 seconds) should be shown.
+//The sender's clock is related to ours by the smallest difference between timecode and arrival seen,
+//frames are delayed by DDP_TIMECODE_LATENCY on top of that to absorb network jitter.
+static uint32_t ddpTimecodeDelay(uint32_t tc) {
+  uint32_t tcMs = (tc >> 16) * 1000 + (((tc & 0xFFFF) * 1000) >> 16);
+  uint32_t now = millis();
+  uint32_t d = (now % DDP_TIMECODE_WRAP + DDP_TIMECODE_WRAP - tcMs) % DDP_TIMECODE_WRAP;
+  uint32_t diff = (d + DDP_TIMECODE_WRAP - ddpTimecodeOffset) % DDP_TIMECODE_WRAP;
+  if (!ddpLastTimecode || now - ddpLastTimecode > 5000 || diff > DDP_TIMECODE_WRAP/2) { //new stream or faster path
+    ddpTimecodeOffset = d; diff = 0;
+  } else if (diff) {
+    ddpTimecodeOffset = (ddpTimecodeOffset + 1) % DDP_TIMECODE_WRAP; //follow slow clock drift
+  }
+  ddpLastTimecode = now;
+  return (diff < DDP_TIMECODE_LATENCY) ? DDP_TIMECODE_LATENCY - diff : 0;
+}
+
+static bool ddpWriteHeld();
+
+void handleDDPPacket(e131_packet_t* p, IPAddress clientIP) {
+  if (p->flags & DDP_QUERY_FLAG) { //answered from loop()
+    if (p->destination == DDP_ID_STATUS || p->destination == DDP_ID_CONFIG) {
+      ddpReplyPending = p->destination;
+      ddpReplyIP = clientIP;
+      ddpReplyPort = e131.remotePort();
     }
+    return;
+  }
+  if (p->flags & DDP_REPLY_FLAG) return; //reply of another device to a query
+  if (p->destination != DDP_ID_DISPLAY && p->destination != DDP_ID_ALL) return;
+
+  uint8_t sn = p->sequenceNum & 0xF;
+  //reject late packets belonging to previous frame
+  if (e131SkipOutOfSequence && ddpIsLate(sn)) {
+    rtStats[REALTIME_MODE_DDP].seqDrops++;
+    return;
   }
 
-  uint32_t start = htonl(p->channelOffset) /3;
-  start += DMXAddress /3;
-  uint16_t stop = start + htons(p->dataLen) /3;
-  uint8_t* data = p->data;
-  uint16_t c = 0;
-  if (p->flags & DDP_TIMECODE_FLAG) c = 4; //packet has timecode flag, we do not support it, but data starts 4 bytes later
+  uint8_t type = DDP_TYPE(p->dataType);
+  uint8_t size = DDP_SIZE(p->dataType);
+  if (size && size != DDP_SIZE_8BIT) return; //only 8 bit per channel
+  uint8_t bpp = (type == DDP_TYPE_RGBW) ? 4 : 3; //undefined type is RGB
 
+  uint32_t start = htonl(p->channelOffset) / bpp;
+  start += DMXAddress / bpp;
+  uint16_t dataLen = htons(p->dataLen); //checked by e131PacketLengthValid()
+  uint16_t count = dataLen / bpp;
+  bool hasTimecode = p->flags & DDP_TIMECODE_FLAG;
+  uint8_t* data = hasTimecode ? p->data + 4 : p->data; //timecode precedes the data
+
+  realtimeIP = clientIP;
   realtimeLock(realtimeTimeoutMs, REALTIME_MODE_DDP);
-  
-  for (uint16_t i = start; i < stop; i++) {
-    setRealtimePixel(i, data[c], data[c+1], data[c+2], 0);
-    c+=3;
+  if (realtimeOverride) return;
+
+  //while a frame with timecode is held in the pixel buffer, the next one is only written to ddpHold
+  if (start < ledCount && count) {
+    NET_LOCK();
+    bool skip = ddpHold.skip();
+    NET_UNLOCK();
+    if (skip && ddpWriteHeld()) e131NewData = true;
+    NET_LOCK();
+    bool direct = ddpHold.write(start, data, count, bpp);
+    NET_UNLOCK();
+    if (direct) setRealtimePixels(start, data, count, bpp);
+  }
+
+  if (p->flags & DDP_PUSH_FLAG) {
+    if (sn) {
+      ddpPrevFrameSpan = ddpLastSequenceNumber ? (sn - ddpLastSequenceNumber + 14) % 15 +1 : 1;
+      if (ddpPrevFrameSpan > 14) ddpPrevFrameSpan = 14; //keep the number after the push for the next frame
+      ddpLastSequenceNumber = sn;
+      ddpFrameSpan = 0;
+    }
+    uint32_t wait = 0;
+    if (hasTimecode) {
+      uint32_t tc; memcpy(&tc, p->data, 4);
+      wait = ddpTimecodeDelay(htonl(tc));
+    }
+    NET_LOCK();
+    bool show = ddpHold.push(millis(), wait);
+    NET_UNLOCK();
+    if (show) e131NewData = true;
+  }
+}
+
+//writes the frame received while another one was held to the pixel buffer, after the held one was shown or dropped.
+//Returns true if that frame is due now
+static bool ddpWriteHeld() {
+  uint16_t start, count;
+  for (;;) {
+    NET_LOCK();
+    const byte* data = ddpHold.take(start, count);
+    bool due = !data && ddpHold.done(millis());
+    NET_UNLOCK();
+    if (!data) return due;
+    setRealtimePixels(start, data, count, ddpHold.bpp());
+  }
+}
+
+//frames with timecode need the copy of the incoming frame to wait for their time, it exists while they arrive
+static void handleDDPHoldBuffer() {
+  bool timecoded = realtimeMode == REALTIME_MODE_DDP && !realtimeOverride && ddpLastTimecode && millis() - ddpLastTimecode < 5000;
+  byte bpp = strip.getPixelBytes();
+  if (ddpHold.attached() && (!timecoded || ddpHold.leds() != ledCount || ddpHold.bpp() != bpp)) {
+    bool held;
+    NET_LOCK();
+    byte* buf = ddpHold.detach(held);
+    NET_UNLOCK();
+    while (e131UniverseUsers) delay(1); //a DDP callback may still be writing into it
+    free(buf);
+    if (held) e131NewData = true;
+    return;
   }
+  if (!timecoded) { ddpHoldNoMem = false; return; }
+  if (ddpHold.attached() || ddpHoldNoMem) return;
+  uint32_t size = ledCount * bpp;
+  byte* buf = (size + strip.getBusMemReserve(false) > ESP.getFreeHeap()) ? nullptr : (byte*)calloc(size, 1);
+  if (!buf) { ddpHoldNoMem = true; return; } //frames are shown when they arrive
+  NET_LOCK();
+  ddpHold.attach(buf, ledCount, bpp);
+  NET_UNLOCK();
+}
+
+//answers DDP status and config queries (discovery), call from loop()
+void handleDDPReply() {
+  handleDDPHoldBuffer();
+  NET_LOCK();
+  bool due = ddpHold.due(millis()); //scheduled by timecode
+  e131FramesSkipped += ddpHold.skipped;
+  ddpHold.skipped = 0;
+  NET_UNLOCK();
+  if (due) {
+    realtimeShow();
+    if (ddpWriteHeld()) e131NewData = true;
+  }
+  if (!ddpReplyPending || !udpConnected) return;
 
-  bool push = p->flags & DDP_PUSH_FLAG;
-  if (push) {
-    e131NewData = true;
-    byte sn = p->sequenceNum & 0xF;
-    if (sn) e131LastSequenceNumber[0] = sn;
+  char json[320]; //room for a server description of only escaped characters
+  if (ddpReplyPending == DDP_ID_STATUS) {
+    StaticJsonDocument<JSON_OBJECT_SIZE(1) + JSON_OBJECT_SIZE(6)> doc;
+    JsonObject status = doc.createNestedObject("status");
+    status["man"] = "WLED";
+    status["mod"] = (const char*)serverDescription; //escaped by the serializer
+    status["ver"] = (const char*)versionString;
+    status["mac"] = escapedMac.c_str();
+    status["push"] = true;
+    status["ntp"] = ntpEnabled;
+    serializeJson(doc, json, sizeof(json));
+  } else {
+    IPAddress ip = Network.localIP(), nm = Network.subnetMask(), gw = Network.gatewayIP();
+    snprintf_P(json, sizeof(json), PSTR("{\"config\":{\"ip\":\"%u.%u.%u.%u\",\"nm\":\"%u.%u.%u.%u\",\"gw\":\"%u.%u.%u.%u\",\"ports\":[{\"port\":0,\"ts\":%u,\"l\":%u,\"ss\":0}]}}"),
+      ip[0], ip[1], ip[2], ip[3], nm[0], nm[1], nm[2], nm[3], gw[0], gw[1], gw[2], gw[3], strip.isRgbw ? DDP_TYPE_RGBW : DDP_TYPE_RGB, ledCount);
   }
+  uint16_t len = strlen(json);
+  byte header[DDP_HEADER_LEN] = {DDP_VERSION_1 | DDP_REPLY_FLAG | DDP_PUSH_FLAG, 0, 0, ddpReplyPending, 0, 0, 0, 0, (byte)(len >> 8), (byte)len};
+  ddpReplyPending = 0;
+
+  notifierUdp.beginPacket(ddpReplyIP, ddpReplyPort);
+  notifierUdp.write(header, DDP_HEADER_LEN);
+  notifierUdp.write((uint8_t*)json, len);
+  notifierUdp.endPacket();
 }
 
 //E1.31 and Art-Net protocol support
-void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
+//false for truncated packets and packets with more data than the protocol allows
+static bool e131PacketLengthValid(e131_packet_t* p, byte protocol, uint16_t len) {
+  switch (protocol) {
+    case P_E131: {
+      if (len < E131_DATA_OFFSET +1) return false;
+      uint16_t count = htons(p->property_value_count); //including start code
+      return count && count <= 513 && E131_DATA_OFFSET + count <= len;
+    }
+    case P_ARTNET: {
+      if (len < ARTNET_DATA_OFFSET) return false;
+      uint16_t count = htons(p->art_length);
+      return count <= 512 && ARTNET_DATA_OFFSET + count <= len;
+    }
+    case P_DDP: {
+      if (len < DDP_HEADER_LEN) return false;
+      uint16_t count = htons(p->dataLen);
+      uint16_t header = (p->flags & DDP_TIMECODE_FLAG) ? DDP_HEADER_LEN +4 : DDP_HEADER_LEN;
+      return count <= DDP_MAX_DATALEN && header + count <= len;
+    }
+    case P_E131_SYNC:   return len >= E131_SYNC_LEN;
+    case P_ARTNET_SYNC: return len >= ARTNET_SYNC_LEN;
+  }
+  return false;
+}
+
+static void decodeE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol, E131Universe* universes, uint8_t numUniverses);
+
+void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol, uint16_t len) {
+  unsigned long start = micros();
+  byte mde = REALTIME_MODE_E131;
+  if (protocol == P_ARTNET || protocol == P_ARTNET_SYNC) mde = REALTIME_MODE_ARTNET;
+  else if (protocol == P_DDP) mde = REALTIME_MODE_DDP;
+
+  if (!e131PacketLengthValid(p, protocol, len)) {
+    rtStats[mde].badLen++;
+    return;
+  }
+  uint8_t numUniverses;
+  E131Universe* universes = e131AcquireUniverses(numUniverses);
+  decodeE131Packet(p, clientIP, protocol, universes, numUniverses);
+  e131ReleaseUniverses();
+  rtStatPacket(mde, len, start);
+}
+
+static void decodeE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol, E131Universe* universes, uint8_t numUniverses){
 
   uint16_t uni = 0, dmxChannels = 0;
   uint8_t* e131_data = nullptr;
   uint8_t seq = 0, mde = REALTIME_MODE_E131;
 
+  if (protocol == P_E131_SYNC || protocol == P_ARTNET_SYNC)
+  {
+    //E1.31 sync packets only apply to the universes that announced their synchronization address
+    if (protocol == P_E131_SYNC && ((p->raw[E131_SYNC_ADDR] << 8) | p->raw[E131_SYNC_ADDR +1]) != e131SyncAddress) return;
+    e131LastSync = millis();
+    e131WaitForSync = (protocol == P_ARTNET_SYNC) || e131SyncAddress;
+    e131FinishFrame();
+    return;
+  }
+
   if (protocol == P_ARTNET)
   {
     uni = p->art_universe;
@@ -61,14 +369,16 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
     e131_data = p->art_data;
     seq = p->art_sequence_number;
     mde = REALTIME_MODE_ARTNET;
+    e131WaitForSync = true; //Art-Net receivers wait for ArtSync once it was seen
   } else if (protocol == P_E131) {
     uni = htons(p->universe);
     dmxChannels = htons(p->property_value_count) -1;
     e131_data = p->property_values;
     seq = p->sequence_number;
+    e131SyncAddress = htons(p->reserved); //synchronization address, 0 if the sender does not sync
+    e131WaitForSync = e131SyncAddress;
   } else { //DDP
-    realtimeIP = clientIP;
-    handleDDPPacket(p);
+    handleDDPPacket(p, clientIP);
     return;
   }
 
@@ -82,22 +392,26 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
   #endif
 
   // only listen for universes we're handling & allocated memory
-  if (uni >= (e131Universe + E131_MAX_UNIVERSE_COUNT)) return;
+  if (uni < e131Universe || uni - e131Universe >= numUniverses) return;
 
   uint8_t previousUniverses = uni - e131Universe;
+  E131Universe &eu = universes[previousUniverses];
 
   if (e131SkipOutOfSequence)
-    if (seq < e131LastSequenceNumber[uni-e131Universe] && seq > 20 && e131LastSequenceNumber[uni-e131Universe] < 250){
+    if (seq < eu.lastSeq && seq > 20 && eu.lastSeq < 250){
       DEBUG_PRINT("skipping E1.31 frame (last seq=");
-      DEBUG_PRINT(e131LastSequenceNumber[uni-e131Universe]);
+      DEBUG_PRINT(eu.lastSeq);
       DEBUG_PRINT(", current seq=");
       DEBUG_PRINT(seq);
       DEBUG_PRINT(", universe=");
       DEBUG_PRINT(uni);
       DEBUG_PRINTLN(")");
+      rtStats[mde].seqDrops++;
       return;
     }
-  e131LastSequenceNumber[uni-e131Universe] = seq;
+  e131CountLoss(eu, seq);
+  eu.lastSeq = seq;
+  eu.lastRx = millis();
 
   // update status info
   realtimeIP = clientIP;
@@ -166,15 +480,13 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
     case DMX_MODE_MULTIPLE_RGBW:
       {
         realtimeLock(realtimeTimeoutMs, mde);
-        bool is4Chan = (DMXMode == DMX_MODE_MULTIPLE_RGBW);
-        const uint16_t dmxChannelsPerLed = is4Chan ? 4 : 3;
-        const uint16_t ledsPerUniverse = is4Chan ? MAX_4_CH_LEDS_PER_UNIVERSE : MAX_3_CH_LEDS_PER_UNIVERSE;
+        const uint16_t dmxChannelsPerLed = (DMXMode == DMX_MODE_MULTIPLE_RGBW) ? 4 : 3;
         if (realtimeOverride) return;
-        uint16_t previousLeds, dmxOffset;
+        uint16_t previousLeds = eu.ledOffset; //precomputed in initE131Universes()
+        uint16_t dmxOffset;
         if (previousUniverses == 0) {
           if (dmxChannels-DMXAddress < 1) return;
           dmxOffset = DMXAddress;
-          previousLeds = 0;
           // First DMX address is dimmer in DMX_MODE_MULTIPLE_DRGB mode.
           if (DMXMode == DMX_MODE_MULTIPLE_DRGB) {
             strip.setBrightness(e131_data[dmxOffset++]);
@@ -182,22 +494,18 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
         } else {
           // All subsequent universes start at the first channel.
           dmxOffset = (protocol == P_ARTNET) ? 0 : 1;
-          uint16_t ledsInFirstUniverse = (MAX_CHANNELS_PER_UNIVERSE - DMXAddress) / dmxChannelsPerLed;
-          previousLeds = ledsInFirstUniverse + (previousUniverses - 1) * ledsPerUniverse;
         }
         uint16_t ledsTotal = previousLeds + (dmxChannels - dmxOffset +1) / dmxChannelsPerLed;
-        if (!is4Chan) {
-          for (uint16_t i = previousLeds; i < ledsTotal; i++) {
-            setRealtimePixel(i, e131_data[dmxOffset], e131_data[dmxOffset+1], e131_data[dmxOffset+2], 0);
-            dmxOffset+=3;
-          }
-        } else {
-          for (uint16_t i = previousLeds; i < ledsTotal; i++) {
-            setRealtimePixel(i, e131_data[dmxOffset], e131_data[dmxOffset+1], e131_data[dmxOffset+2], e131_data[dmxOffset+3]);
-            dmxOffset+=4;
-          }
-        }
-        break;
+
+        //assemble frames from all universes and show each frame once
+        if (eu.inFrame) e131FinishFrame(); //next frame started before this one was complete
+        if (ledsTotal > previousLeds) setRealtimePixels(previousLeds, e131_data + dmxOffset, ledsTotal - previousLeds, dmxChannelsPerLed);
+        NET_LOCK();
+        eu.inFrame = true;
+        if (!e131FrameStart) e131FrameStart = millis() | 1; //0 means no frame pending
+        if (!e131SyncActive() && e131FrameComplete()) e131FinishFrameLocked();
+        NET_UNLOCK();
+        return;
       }
     default:
       DEBUG_PRINTLN(F("unknown E1.31 DMX mode"));
@@ -52,7 +52,21 @@ void initDMX();
 void handleDMX();
 
 //e131.cpp
-void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol);
+//state of one received universe
+struct E131Universe {
+  uint16_t ledOffset = 0;      //first LED of the universe
+  uint8_t lastSeq = 0;         //to detect packet loss
+  bool inFrame = false;        //received for the frame being assembled
+  uint32_t lost = 0;           //packets lost (sequence gaps)
+  unsigned long lastRx = 0;    //universes received recently make up a frame
+};
+void initE131Universes();
+E131Universe* e131AcquireUniverses(uint8_t &num);
+void e131ReleaseUniverses();
+void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol, uint16_t len);
+void e131FinishFrame();
+void handleE131Frame();
+void handleDDPReply();
 
 //file.cpp
 bool handleFileRead(AsyncWebServerRequest*, String path);
@@ -91,17 +105,60 @@ void initIR();
 void handleIR();
 
 //json.cpp
+#include <memory>
 #include "ESPAsyncWebServer.h"
 #include "src/dependencies/json/ArduinoJson-v6.h"
 #include "src/dependencies/json/AsyncJson-v6.h"
 #include "FX.h"
 
 void deserializeSegment(JsonObject elem, byte it);
+uint16_t setSegmentPixels(byte id, uint16_t pos, const uint8_t* data, uint16_t count, uint8_t bpp);
+bool handleSegmentPixels(const uint8_t* data, size_t len);
 bool deserializeState(JsonObject root);
 void serializeSegment(JsonObject& root, WS2812FX::Segment& seg, byte id, bool forPreset = false, bool segmentBounds = true);
-void serializeState(JsonObject root, bool forPreset = false, bool includeBri = true, bool segmentBounds = true);
+void serializeState(JsonObject root, bool forPreset = false, bool includeBri = true, bool segmentBounds = true, bool includeSegments = true);
 void serializeInfo(JsonObject root);
+void serializePerf(JsonObject root);
+void serializeRealtimeStats(JsonObject root);
+//state JSON serialized once per change, shared by HTTP, websockets and MQTT
+struct StateSnapshot {
+  uint32_t etag = 0;            //hash of the JSON, only changes if the JSON does
+  uint32_t version = 0;         //stateVersion it was serialized at
+  unsigned long time = 0;
+  size_t len = 0;
+  char* json = nullptr;
+  ~StateSnapshot() { free(json); }
+};
+std::shared_ptr<StateSnapshot> getStateSnapshot();
+//produces /json (0), /json/state (1), /json/info (2) or /json/si (3) piece by piece,
+//so no document for the whole response is needed
+//the state is taken from the snapshot unless direct is set
+class JsonStream {
+  public:
+    JsonStream(byte subJson, bool direct = false) : _subJson(subJson), _direct(direct) {}
+    ~JsonStream();
+    bool next();                                //makes the next piece current, false at the end
+    size_t read(uint8_t* out, size_t maxLen);   //copies the next bytes of the response, 0 at the end
+    size_t collect(std::function<char*(size_t)> alloc); //copies the whole response into a buffer of alloc(len) bytes
+    const char* piece = nullptr;
+    size_t pieceLen = 0;
+    bool pieceFlash = false;                    //piece is in PROGMEM
+    bool failed = false;                        //ended early, out of memory or a section did not fit its document
+  private:
+    bool fail();
+    bool setFlash(const char* p);
+    bool setText(DynamicJsonDocument& doc, char lead = 0, bool open = false);
+    byte _subJson;
+    bool _direct;
+    std::shared_ptr<StateSnapshot> _state;
+    byte _step = 0;
+    byte _seg = 0;
+    byte _segCount = 0;
+    char* _text = nullptr;
+    size_t _pos = 0;
+};
 void serveJson(AsyncWebServerRequest* request);
+uint32_t liveViewColor(uint32_t c);
 bool serveLiveLeds(AsyncWebServerRequest* request, uint32_t wsClient = 0);
 
 //led.cpp
@@ -164,13 +221,53 @@ bool isAsterisksOnly(const char* str, byte maxLen);
 void handleSettingsSet(AsyncWebServerRequest *request, byte subPage);
 bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply=true);
 int getNumVal(const String* req, uint16_t pos);
+bool updateVal(const String* req, int pos, byte* val, byte minv=0, byte maxv=255);
 bool updateVal(const String* req, const char* key, byte* val, byte minv=0, byte maxv=255);
+//HTTP API parameters of one request, keys of one or two letters hashed to slots
+struct ApiParams {
+  uint16_t key[API_PARAM_SLOTS];
+  int16_t pos[API_PARAM_SLOTS];  //position in the request, 0 = empty slot
+  bool eq[API_PARAM_SLOTS];      //followed by '='
+};
+void parseApiParams(const String& req, ApiParams& params);
+int apiParam(const ApiParams& params, const __FlashStringHelper* key);
+
+//timesync.cpp
+void timeSyncSetReference(IPAddress ip);
+bool timeSyncLocked(IPAddress ip);
+void handleTimeSync();
+void handleTimeSyncPacket(const byte* udpIn, uint16_t len, IPAddress ip, uint16_t port);
 
 //udp.cpp
 void notify(byte callMode, bool followUp=false);
+void notifySegmentSync(byte callMode);
+void handleSegmentSync(const uint8_t* udpIn, uint16_t len, IPAddress ip);
 void realtimeLock(uint32_t timeoutMs, byte md = REALTIME_MODE_GENERIC);
 void handleNotifications();
+bool handleUdpPacket();
 void setRealtimePixel(uint16_t i, byte r, byte g, byte b, byte w);
+void setRealtimePixels(uint16_t i, const uint8_t* data, uint16_t count, uint8_t stride);
+bool handleDrlePacket(const uint8_t* udpIn, uint16_t packetSize);
+//ingest statistics of one realtime protocol, indexed by REALTIME_MODE_
+struct RealtimeStats {
+  uint32_t packets = 0;
+  uint32_t bytes = 0;
+  uint32_t frames = 0;
+  uint32_t seqDrops = 0;       //packets rejected by the sequence filter
+  uint32_t badLen = 0;         //short or oversized packets
+  uint32_t decodeUs = 0;       //average time to decode a packet
+  uint32_t latencyUs = 0;      //average time from the first packet of a frame until it was shown
+  uint16_t pps = 0, fps = 0;   //last second
+  uint32_t bps = 0;
+  uint32_t lastPackets = 0, lastBytes = 0, lastFrames = 0;
+};
+void rtStatPacket(byte mode, uint16_t len, unsigned long decodeStart);
+void rtStatFrame(unsigned long rxTime);
+void handleRealtimeStats();
+bool realtimeBuffered();
+void realtimeShow();
+void handleRealtimeBuffer();
+void freeRealtimeBuffer();
 void refreshNodeList();
 void sendSysInfoUDP();
 
@@ -244,6 +341,7 @@ void serveSettings(AsyncWebServerRequest* request, bool post = false);
 void handleWs();
 void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len);
 void sendDataWs(AsyncWebSocketClient * client = nullptr);
+void serializeWsClients(JsonArray clients);
 
 //xml.cpp
 void XML_response(AsyncWebServerRequest *request, char* dest = nullptr);
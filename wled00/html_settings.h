@@ -264,7 +264,8 @@ E1.31 info</a><br>Timeout: <input name="ET" type="number" min="1" max="65000"
 required> ms<br>Force max brightness: <input type="checkbox" name="FB"><br>
 Disable realtime gamma correction: <input type="checkbox" name="RG"><br>
 Realtime LED offset: <input name="WO" type="number" min="-255" max="255" 
-required><h3>Alexa Voice Assistant</h3>Emulate Alexa device: <input 
+required><br>Buffered frames: <input name="RB" type="number" min="0" max="3" 
+required> (0 = show right away)<h3>Alexa Voice Assistant</h3>Emulate Alexa device: <input 
 type="checkbox" name="AL"><br>Alexa invocation name: <input name="AI" 
 maxlength="32"><h3>Blynk</h3><b>
 Blynk, MQTT and Hue sync all connect to external hosts!<br>
@@ -156,8 +156,43 @@ void deserializeSegment(JsonObject elem, byte it)
   }
 }
 
+//writes count R,G,B(,W) pixels to segment id from LED pos on, frozen like with the JSON "i" array
+//returns the number of pixels written, those beyond the segment end are dropped
+uint16_t setSegmentPixels(byte id, uint16_t pos, const uint8_t* data, uint16_t count, uint8_t bpp)
+{
+  if (id >= strip.getMaxSegments()) return 0;
+  WS2812FX::Segment& seg = strip.getSegment(id);
+  if (!seg.isActive()) return 0;
+  uint16_t len = seg.length();
+  if (pos >= len) return 0;
+  if (count > len - pos) count = len - pos;
+
+  strip.setPixelSegment(id);
+  //freeze and init to black
+  if (!seg.getOption(SEG_OPTION_FREEZE)) {
+    seg.setOption(SEG_OPTION_FREEZE, true);
+    strip.fill(0);
+    stateVersion++; //"frz" changed, the pixels themselves are not part of the state
+  }
+  strip.setSegmentPixels(pos, data, count, bpp);
+  strip.setPixelSegment(255);
+  strip.trigger();
+  return count;
+}
+
+//a complete binary pixel update, see PIXEL_SET_HEADER_LEN
+bool handleSegmentPixels(const uint8_t* data, size_t len)
+{
+  if (len < PIXEL_SET_HEADER_LEN || len > PIXEL_SET_MAX_LEN) return false;
+  uint8_t bpp = (data[1] & PIXEL_SET_RGBW) ? 4 : 3;
+  uint16_t pos = (data[2] << 8) | data[3];
+  setSegmentPixels(data[0], pos, data + PIXEL_SET_HEADER_LEN, (len - PIXEL_SET_HEADER_LEN) / bpp, bpp);
+  return true;
+}
+
 bool deserializeState(JsonObject root)
 {
+  stateVersion++;
   strip.applyToAllSelected = false;
   bool stateResponse = root[F("v")] | false;
 
@@ -335,7 +370,7 @@ void serializeSegment(JsonObject& root, WS2812FX::Segment& seg, byte id, bool fo
   root[F("mi")]  = seg.getOption(SEG_OPTION_MIRROR);
 }
 
-void serializeState(JsonObject root, bool forPreset, bool includeBri, bool segmentBounds)
+void serializeState(JsonObject root, bool forPreset, bool includeBri, bool segmentBounds, bool includeSegments)
 {
   if (includeBri) {
     root["on"] = (bri > 0);
@@ -377,6 +412,7 @@ void serializeState(JsonObject root, bool forPreset, bool includeBri, bool segme
   }
 
   root[F("mainseg")] = strip.getMainSegmentId();
+  if (!includeSegments) return;
 
   JsonArray seg = root.createNestedArray("seg");
   for (byte s = 0; s < strip.getMaxSegments(); s++)
@@ -431,11 +467,90 @@ void serializeInfo(JsonObject root)
   leds[F("maxpwr")] = (strip.currentMilliamps)? strip.ablMilliampsMax : 0;
   leds[F("maxseg")] = strip.getMaxSegments();
   leds[F("seglock")] = false; //will be used in the future to prevent modifications to segment config
+  leds[F("rcfg")] = busReconfigTime; //time in us the last LED settings change took to apply
+  leds[F("mem")] = busses.getMemUsage(); //bytes allocated by all busses
+  leds[F("maxmem")] = MAX_LED_MEMORY;
+
+  //LED outputs that were not created because they did not fit into memory
+  JsonArray leds_rej = leds.createNestedArray(F("rej"));
+  for (uint8_t i = 0; i < busses.getNumRejected(); i++) {
+    BusRejection* r = busses.getRejected(i);
+    JsonObject rej = leds_rej.createNestedObject();
+    rej[F("n")] = r->cfgNr;
+    rej[F("type")] = r->type;
+    rej[F("len")] = r->count;
+    rej[F("why")] = r->reason;
+    rej[F("need")] = r->needed;
+    rej[F("avail")] = r->available;
+  }
 
   root[F("str")] = syncToggleReceive;
 
   root[F("name")] = serverDescription;
   root[F("udpport")] = udpPort;
+
+  JsonObject e131info = root.createNestedObject(F("e131")); //E1.31 / Art-Net frame assembly
+  e131info[F("frames")] = e131Frames;
+  e131info[F("inc")] = e131FramesIncomplete;
+  e131info[F("skip")] = e131FramesSkipped;
+  e131info[F("sync")] = e131WaitForSync && e131LastSync && millis() - e131LastSync < E131_SYNC_TIMEOUT;
+  JsonArray e131_lost = e131info.createNestedArray(F("lost")); //lost packets per universe, starting at e131Universe
+  uint8_t numUniverses;
+  E131Universe* universes = e131AcquireUniverses(numUniverses);
+  for (uint8_t u = 0; u < numUniverses; u++) e131_lost.add(universes[u].lost);
+  e131ReleaseUniverses();
+  JsonArray e131_mc = e131info.createNestedArray(F("mc")); //joined multicast groups 239.255.hi.lo as [first, last] universe ranges
+  uint16_t mcFirst = e131.multicastUniverse();
+  for (uint16_t u = mcFirst, end = mcFirst + e131.multicastCount(); u < end; u++) {
+    if (!e131.multicastJoined(u)) continue;
+    uint16_t last = u;
+    while (last +1 < end && e131.multicastJoined(last +1)) last++;
+    JsonArray range = e131_mc.createNestedArray();
+    range.add(u); range.add(last);
+    u = last;
+  }
+
+  JsonObject udprx = root.createNestedObject(F("udprx")); //UDP receive queue
+  udprx[F("n")] = udpRxPackets;
+  udprx[F("rej")] = udpRxRejected; //discarded by the handler, packets lost in the socket queue never show up here
+  udprx[F("defer")] = udpRxDeferred;
+  udprx[F("q")] = udpRxDepth;
+  udprx[F("qmax")] = udpRxMaxDepth;
+
+  JsonObject rtbuf = root.createNestedObject(F("rtbuf")); //realtime jitter buffer
+  rtbuf[F("depth")] = realtimeBufferDepth;
+  rtbuf[F("q")] = rtBufCount;
+  rtbuf[F("int")] = rtBufInterval; //us between frames
+  rtbuf[F("n")] = rtBufFrames;
+  rtbuf[F("late")] = rtBufLate;
+  rtbuf[F("early")] = rtBufEarly;
+  rtbuf[F("nomem")] = rtBufNoMem;
+
+  JsonObject rt = root.createNestedObject("rt");
+  serializeRealtimeStats(rt);
+
+  JsonObject ts = root.createNestedObject(F("ts")); //effect clock sync
+  ts["en"] = timeSyncEnabled;
+  ts[F("ref")] = IPAddress(timeSync.ref).toString();
+  ts[F("off")] = timeSync.offset;
+  ts[F("rtt")] = timeSync.rtt;
+  ts[F("err")] = timeSync.error; //ms, -1 = not synced
+  ts["n"] = timeSync.numSamples;
+  ts[F("lead")] = timeSync.leading; //the reference follows this node
+
+  JsonObject fgrid = root.createNestedObject(F("fgrid")); //frame aligned show
+  fgrid[F("per")] = strip.framePeriod;
+  fgrid[F("shown")] = strip.frameShown;
+  fgrid[F("miss")] = strip.frameMissed;
+  fgrid[F("late")] = strip.frameLate;
+
+  #ifdef WLED_ENABLE_ADALIGHT
+  JsonObject serial = root.createNestedObject(F("serial")); //Adalight/TPM2
+  serial[F("baud")] = (uint32_t)serialBaud * 100;
+  serial[F("fps")] = rtStats[REALTIME_MODE_ADALIGHT].fps;
+  serial[F("n")] = rtStats[REALTIME_MODE_ADALIGHT].frames;
+  serial[F("err")] = serialErrors;
+  #endif
   root["live"] = (bool)realtimeMode;
 
   switch (realtimeMode) {
@@ -459,6 +574,8 @@ void serializeInfo(JsonObject root)
 
   #ifdef WLED_ENABLE_WEBSOCKETS
   root[F("ws")] = ws.count();
+  JsonArray wsd = root.createNestedArray(F("wsd")); //clients receiving delta updates
+  serializeWsClients(wsd);
   #else
   root[F("ws")] = -1;
   #endif
@@ -706,6 +823,284 @@ void serializeNodes(JsonObject root)
   }
 }
 
+//transmission timing of each bus, to tell whether the LED output or the effects limit the frame rate
+void serializePerf(JsonObject root)
+{
+  root[F("fps")] = strip.getFps();
+  root[F("on")] = busses.timingEnabled;
+  root[F("jsheap")] = jsonStreamMinHeap; //lowest free heap while a /json section was serialized
+  root[F("jsfail")] = jsonStreamFails;
+
+  JsonArray perf_bus = root.createNestedArray(F("bus"));
+  for (uint8_t i = 0; i < busses.getNumBusses(); i++) {
+    Bus* bus = busses.getBus(i);
+    if (bus == nullptr) continue;
+    JsonObject b = perf_bus.createNestedObject();
+    b[F("type")] = bus->getType();
+    b[F("len")] = bus->getLength();
+    b[F("n")] = bus->timing.shows;
+    b[F("show")] = bus->timing.showAvg; //us spent in show()
+    b[F("showmax")] = bus->timing.showMax;
+    b[F("busy")] = bus->timing.busyAvg; //us until the bus could show again
+    b[F("busymax")] = bus->timing.busyMax;
+    uint32_t wire = bus->getWireTime();
+    b[F("wire")] = wire; //theoretical us per frame
+    b[F("maxfps")] = wire ? 1000000 / wire : 0;
+    b[F("sg")] = bus->splitGroup;
+  }
+
+  //estimated frame rate of each logical LED range when split across 1, 2, ... outputs
+  JsonArray perf_plan = root.createNestedArray(F("plan"));
+  uint8_t numBusses = busses.getNumBusses();
+  uint8_t taken[WLED_MAX_BUSSES];
+  for (uint8_t i = 0; i < numBusses; i++) {
+    uint8_t busPins[5];
+    busses.getBus(i)->getPins(busPins);
+    taken[i] = busPins[0];
+  }
+  for (uint8_t i = 0; i < numBusses; i++) {
+    Bus* bus = busses.getBus(i);
+    if (!IS_DIGITAL(bus->getType()) || IS_2PIN(bus->getType())) continue;
+    uint8_t pins[WLED_MAX_BUSSES];
+    uint8_t numParts = 0;
+    uint16_t len = 0;
+    uint8_t first = i;
+    for (; i < numBusses; i++) {
+      Bus* part = busses.getBus(i);
+      if (numParts && (!bus->splitGroup || part->splitGroup != bus->splitGroup)) { i--; break; }
+      uint8_t partPins[5];
+      part->getPins(partPins);
+      pins[numParts++] = partPins[0];
+      len += part->getLength();
+    }
+    uint8_t maxOutputs = numParts + WLED_MAX_BUSSES - numBusses;
+    BusManager::planFreePins(pins, numParts, maxOutputs, taken, numBusses);
+
+    JsonObject plan = perf_plan.createNestedObject();
+    plan[F("start")] = bus->getStart();
+    plan[F("len")] = len;
+    plan[F("outs")] = numParts;
+    JsonArray plan_fps = plan.createNestedArray(F("fps"));
+    for (uint8_t k = 1; k <= maxOutputs; k++) plan_fps.add(BusManager::planSplit(bus->getType(), len, pins, k, first));
+  }
+}
+
+//ingest counters of each realtime protocol that received packets
+void serializeRealtimeStats(JsonObject root)
+{
+  for (byte m = REALTIME_MODE_UDP; m <= REALTIME_MODE_DDP; m++) {
+    RealtimeStats &s = rtStats[m];
+    if (!s.packets && !s.badLen) continue;
+    const __FlashStringHelper* name;
+    switch (m) {
+      case REALTIME_MODE_UDP:      name = F("udp"); break;
+      case REALTIME_MODE_HYPERION: name = F("hyperion"); break;
+      case REALTIME_MODE_E131:     name = F("e131"); break;
+      case REALTIME_MODE_ADALIGHT: name = F("adalight"); break;
+      case REALTIME_MODE_ARTNET:   name = F("artnet"); break;
+      case REALTIME_MODE_TPM2NET:  name = F("tpm2net"); break;
+      default:                     name = F("ddp"); break;
+    }
+    JsonObject p = root.createNestedObject(name);
+    p[F("pps")] = s.pps;
+    p[F("bps")] = s.bps;
+    p[F("fps")] = s.fps;
+    p[F("n")] = s.packets;
+    p[F("frames")] = s.frames;
+    p[F("seq")] = s.seqDrops; //out of sequence drops
+    p[F("len")] = s.badLen;   //short or oversized packets
+    p[F("dec")] = s.decodeUs; //us per packet
+    p[F("lat")] = s.latencyUs; //us from first packet to show
+  }
+}
+
+JsonStream::~JsonStream()
+{
+  free(_text);
+}
+
+bool JsonStream::setFlash(const char* p)
+{
+  piece = p;
+  pieceLen = strlen_P(p);
+  pieceFlash = true;
+  return true;
+}
+
+//ends the response early, the client gets incomplete JSON rather than silently truncated data
+bool JsonStream::fail()
+{
+  _step = 255;
+  failed = true;
+  jsonStreamFails++;
+  return false;
+}
+
+//serializes doc into the current piece, lead is written before it and open drops the closing brace
+bool JsonStream::setText(DynamicJsonDocument& doc, char lead, bool open)
+{
+  uint32_t heap = ESP.getFreeHeap(); //doc is still allocated, this is the peak of the section
+  if (heap < jsonStreamMinHeap) jsonStreamMinHeap = heap;
+  if (doc.overflowed()) {
+    DEBUG_PRINTLN(F("JSON stream section overflowed!"));
+    return fail();
+  }
+  size_t len = measureJson(doc);
+  _text = (char*)malloc(len +2);
+  if (!_text) {
+    DEBUG_PRINTLN(F("JSON stream out of memory!"));
+    return fail();
+  }
+  byte off = 0;
+  if (lead) _text[off++] = lead;
+  serializeJson(doc, _text + off, len +1);
+  piece = _text;
+  pieceLen = len + off - open;
+  pieceFlash = false;
+  return true;
+}
+
+bool JsonStream::next()
+{
+  free(_text);
+  _text = nullptr;
+  _pos = 0;
+  bool wrap  = (_subJson == 0 || _subJson == 3);
+  bool state = (_subJson != 2);
+  bool info  = (_subJson != 1);
+
+  while (_step < 12) {
+    switch (_step++) {
+      case 0: if (wrap) return setFlash(PSTR("{\"state\":")); break;
+      case 1: if (state && !_direct) { //the whole state from the shared snapshot
+          _state = getStateSnapshot();
+          if (!_state) return fail();
+          piece = _state->json;
+          pieceLen = _state->len;
+          pieceFlash = false;
+          _step = 5;
+          return true;
+        }
+        if (state) {
+          DynamicJsonDocument doc(JSON_STREAM_SEG_SIZE);
+          serializeState(doc.to<JsonObject>(), false, true, true, false);
+          return setText(doc, 0, true);
+        } break;
+      case 2: if (state) return setFlash(PSTR(",\"seg\":[")); break;
+      case 3: //one segment per piece
+        if (!state) break;
+        for (; _seg < strip.getMaxSegments(); _seg++) {
+          WS2812FX::Segment& sg = strip.getSegment(_seg);
+          if (!sg.isActive()) continue;
+          DynamicJsonDocument doc(JSON_STREAM_SEG_SIZE);
+          JsonObject seg = doc.to<JsonObject>();
+          serializeSegment(seg, sg, _seg, false, true);
+          _seg++;
+          _step--; //come back for the next segment
+          return setText(doc, (_segCount++) ? ',' : 0);
+        }
+        break;
+      case 4: if (state) return setFlash(PSTR("]}")); break;
+      case 5: if (wrap) return setFlash(PSTR(",\"info\":")); break;
+      case 6: if (info) { //info grows with busses, usermods etc., retry once with twice the size before failing
+          for (size_t size = JSON_STREAM_INFO_SIZE; ; size *= 2) {
+            DynamicJsonDocument doc(size);
+            serializeInfo(doc.to<JsonObject>());
+            if (!doc.overflowed() || size >= 2*JSON_STREAM_INFO_SIZE) return setText(doc);
+          }
+        } break;
+      case 7: if (_subJson == 0) return setFlash(PSTR(",\"effects\":")); break;
+      case 8: if (_subJson == 0) return setFlash(JSON_mode_names); break;
+      case 9: if (_subJson == 0) return setFlash(PSTR(",\"palettes\":")); break;
+      case 10: if (_subJson == 0) return setFlash(JSON_palette_names); break;
+      case 11: if (wrap) return setFlash(PSTR("}")); break;
+    }
+  }
+  piece = nullptr;
+  pieceLen = 0;
+  return false;
+}
+
+size_t JsonStream::read(uint8_t* out, size_t maxLen)
+{
+  size_t n = 0;
+  while (n < maxLen) {
+    if (_pos >= pieceLen && !next()) break;
+    size_t c = pieceLen - _pos;
+    if (c > maxLen - n) c = maxLen - n;
+    if (pieceFlash) memcpy_P(out + n, piece + _pos, c);
+    else            memcpy(out + n, piece + _pos, c);
+    _pos += c;
+    n += c;
+  }
+  return n;
+}
+
+size_t JsonStream::collect(std::function<char*(size_t)> alloc)
+{
+  //the length is needed up front, so keep the serialized pieces until all are known
+  const char* pieces[JSON_STREAM_MAX_PIECES];
+  size_t lens[JSON_STREAM_MAX_PIECES];
+  bool flash[JSON_STREAM_MAX_PIECES], owned[JSON_STREAM_MAX_PIECES];
+  byte n = 0;
+  size_t len = 0;
+  while (n < JSON_STREAM_MAX_PIECES && next()) {
+    pieces[n] = piece;
+    lens[n] = pieceLen;
+    flash[n] = pieceFlash;
+    owned[n] = (piece == _text);
+    if (owned[n]) _text = nullptr; //freed below instead of by next()
+    len += lens[n++];
+  }
+  char* out = (failed || piece) ? nullptr : alloc(len);
+  if (out) {
+    for (byte i = 0; i < n; i++) {
+      if (flash[i]) memcpy_P(out, pieces[i], lens[i]);
+      else          memcpy(out, pieces[i], lens[i]);
+      out += lens[i];
+    }
+  }
+  for (byte i = 0; i < n; i++) if (owned[i]) free((void*)pieces[i]);
+  return out ? len : 0;
+}
+
+//used by loop() and the async web server task, only copied and replaced under NET_LOCK.
+//Nothing is built or freed under the lock, the last reference to a replaced snapshot is dropped after it.
+static std::shared_ptr<StateSnapshot> stateSnapshot;
+
+std::shared_ptr<StateSnapshot> getStateSnapshot()
+{
+  unsigned long now = millis();
+  uint32_t version = stateVersion; //taken before serializing, a change during it causes another rebuild
+  NET_LOCK();
+  std::shared_ptr<StateSnapshot> cur = stateSnapshot;
+  bool fresh = cur && cur->version == version && now - cur->time < STATE_SNAPSHOT_MAX_AGE;
+  NET_UNLOCK();
+  if (fresh) return cur;
+
+  std::shared_ptr<StateSnapshot> s(new StateSnapshot());
+  JsonStream stream(1, true);
+  s->len = stream.collect([&s](size_t len) { s->json = (char*)malloc(len +1); return s->json; });
+  if (!s->len) return cur; //out of memory, a stale state is better than none
+  s->json[s->len] = 0;
+  s->etag = 2166136261UL; //FNV-1a
+  for (size_t i = 0; i < s->len; i++) s->etag = (s->etag ^ (uint8_t)s->json[i]) * 16777619UL;
+  s->version = version;
+  s->time = now;
+
+  NET_LOCK();
+  std::shared_ptr<StateSnapshot> old = stateSnapshot;
+  if (old && old->etag == s->etag) { //unchanged, keep the buffer consumers may hold
+    old->version = version;
+    old->time = now;
+  } else {
+    stateSnapshot = s;
+  }
+  std::shared_ptr<StateSnapshot> result = stateSnapshot;
+  NET_UNLOCK();
+  return result;
+}
+
 void serveJson(AsyncWebServerRequest* request)
 {
   byte subJson = 0;
@@ -715,6 +1110,7 @@ void serveJson(AsyncWebServerRequest* request)
   else if (url.indexOf("si") > 0) subJson = 3;
   else if (url.indexOf("nodes") > 0) subJson = 4;
   else if (url.indexOf("palx") > 0) subJson = 5;
+  else if (url.indexOf("perf") > 0) subJson = 6;
   else if (url.indexOf("live")  > 0) {
     serveLiveLeds(request);
     return;
@@ -732,29 +1128,58 @@ void serveJson(AsyncWebServerRequest* request)
     return;
   }
 
+  if (subJson == 1) { //state from the shared snapshot, clients revalidate with its ETag
+    std::shared_ptr<StateSnapshot> state = getStateSnapshot();
+    if (state) {
+      char etag[11];
+      sprintf_P(etag, PSTR("\"%08x\""), state->etag);
+      AsyncWebServerResponse* response;
+      if (request->hasHeader("If-None-Match") && request->header("If-None-Match") == etag) {
+        response = request->beginResponse(304);
+      } else {
+        response = request->beginResponse("application/json", state->len, [state](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+          size_t n = state->len - index;
+          if (n > maxLen) n = maxLen;
+          memcpy(buffer, state->json + index, n);
+          return n;
+        });
+      }
+      response->addHeader(F("ETag"), etag);
+      response->addHeader(F("Cache-Control"), F("no-cache"));
+      request->send(response);
+      return;
+    }
+  }
+
+  if (subJson < 4) { //state and info are streamed section by section
+    std::shared_ptr<JsonStream> stream(new JsonStream(subJson, subJson == 1)); //state directly if there is no snapshot
+    request->send(request->beginChunkedResponse("application/json", [stream](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+      return stream->read(buffer, maxLen);
+    }));
+    return;
+  }
+
   AsyncJsonResponse* response = new AsyncJsonResponse(JSON_BUFFER_SIZE);
   JsonObject doc = response->getRoot();
 
   switch (subJson)
   {
-    case 1: //state
-      serializeState(doc); break;
-    case 2: //info
-      serializeInfo(doc); break;
     case 4: //node list
       serializeNodes(doc); break;
     case 5: //palettes
       serializePalettes(doc, request); break;
-    default: //all
-      JsonObject state = doc.createNestedObject("state");
-      serializeState(state);
-      JsonObject info = doc.createNestedObject("info");
-      serializeInfo(info);
-      if (subJson != 3)
-      {
-        doc[F("effects")]  = serialized((const __FlashStringHelper*)JSON_mode_names);
-        doc[F("palettes")] = serialized((const __FlashStringHelper*)JSON_palette_names);
+    case 6: //bus timing
+      if (request->hasParam(F("on"))) {
+        bool on = request->getParam(F("on"))->value().toInt();
+        if (on && !busses.timingEnabled) busses.resetTiming(); //no stale averages from an earlier run
+        busses.timingEnabled = on;
+      }
+      serializePerf(doc);
+      if (request->hasParam(F("reset"))) {
+        busses.resetTiming();
+        jsonStreamMinHeap = UINT32_MAX;
       }
+      break;
   }
 
   response->setLength();
@@ -763,6 +1188,13 @@ void serveJson(AsyncWebServerRequest* request)
 
 #define MAX_LIVE_LEDS 180
 
+//RGB of a pixel as shown in the binary live view, the white channel is added to all three
+uint32_t liveViewColor(uint32_t c)
+{
+  uint8_t w = c >> 24;
+  return ((uint32_t)qadd8(w, c >> 16) << 16) | ((uint32_t)qadd8(w, c >> 8) << 8) | qadd8(w, c);
+}
+
 bool serveLiveLeds(AsyncWebServerRequest* request, uint32_t wsClient)
 {
   AsyncWebSocketClient * wsc = nullptr;
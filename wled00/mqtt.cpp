@@ -47,6 +47,7 @@ void onMqttConnect(bool sessionPresent)
     mqtt->subscribe(subuf, 0);
   }
 
+  mqttPublishedEtag = 0; //publish the state even if unchanged
   doPublishMqtt = true;
   DEBUG_PRINTLN(F("MQTT ready"));
 }
@@ -105,6 +106,9 @@ void publishMqtt()
 {
   doPublishMqtt = false;
   if (!WLED_MQTT_CONNECTED) return;
+  std::shared_ptr<StateSnapshot> state = getStateSnapshot();
+  if (state && state->etag == mqttPublishedEtag) return; //nothing changed since the last publish
+  mqttPublishedEtag = state ? state->etag : 0;
   DEBUG_PRINTLN(F("Publish MQTT"));
 
   char s[10];
@@ -119,6 +119,13 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
 
       if (busConfigs[s] != nullptr) delete busConfigs[s];
       busConfigs[s] = new BusConfig(type, pins, start, length, colorOrder, request->hasArg(cv));
+      //the page lists each part of a split range as an output, unchanged parts stay in their range
+      Bus* bus = busses.getBus(s);
+      if (bus && bus->splitGroup && bus->getType() == type && bus->getStart() == start && bus->getLength() == length) {
+        uint8_t busPins[5];
+        bus->getPins(busPins);
+        if (busPins[0] == pins[0]) busConfigs[s]->splitGroup = bus->splitGroup;
+      }
       //if (BusManager::isRgbw(type)) strip.isRgbw = true; //20fps
       //strip.isRgbw = true;
       doInitBusses = true;
@@ -235,6 +242,8 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
     arlsDisableGammaCorrection = request->hasArg(F("RG"));
     t = request->arg(F("WO")).toInt();
     if (t >= -255  && t <= 255) arlsOffset = t;
+    t = request->arg(F("RB")).toInt();
+    if (t >= 0  && t <= REALTIME_BUFFER_MAX) realtimeBufferDepth = t;
 
     alexaEnabled = request->hasArg(F("AL"));
     strlcpy(alexaInvocationName, request->arg(F("AI")).c_str(), 33);
@@ -404,6 +413,7 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
 
   if (subPage != 2 && (subPage != 6 || !doReboot)) serializeConfig(); //do not save if factory reset or LED settings (which are saved after LED re-init)
   if (subPage == 4) alexaInit();
+  if (subPage == 2 || subPage == 4) doInitE131 = true; //LED count or DMX settings may have changed, re-init in loop()
 }
 
 
@@ -411,14 +421,14 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
 //helper to get int value at a position in string
 int getNumVal(const String* req, uint16_t pos)
 {
-  return req->substring(pos+3).toInt();
+  if (pos +3 >= req->length()) return 0;
+  return atol(req->c_str() + pos +3);
 }
 
 
 //helper to get int value at a position in string
-bool updateVal(const String* req, const char* key, byte* val, byte minv, byte maxv)
+bool updateVal(const String* req, int pos, byte* val, byte minv, byte maxv)
 {
-  int pos = req->indexOf(key);
   if (pos < 1) return false;
 
   if (req->charAt(pos+3) == '~') {
@@ -444,6 +454,58 @@ bool updateVal(const String* req, const char* key, byte* val, byte minv, byte ma
   return true;
 }
 
+bool updateVal(const String* req, const char* key, byte* val, byte minv, byte maxv)
+{
+  return updateVal(req, req->indexOf(key), val, minv, maxv);
+}
+
+
+static uint8_t apiParamSlot(uint16_t key)
+{
+  return ((uint32_t)key * 2654435761UL) >> (32 - API_PARAM_SLOTS_BITS);
+}
+
+//splits the request at '&' once, so each parameter is found without scanning the whole request
+void parseApiParams(const String& req, ApiParams& params)
+{
+  memset(&params, 0, sizeof(params));
+  const char* s = req.c_str();
+  uint16_t len = req.length();
+  byte n = 0;
+  for (uint16_t t = 0; t < len && n < API_PARAM_MAX; t++) {
+    if (s[t] != '&') continue;
+    char c0 = s[t+1], c1 = s[t+2];
+    if (!c0 || c0 == '&') continue;
+    bool oneLetter = (c1 == '=');
+    uint16_t key = oneLetter ? c0 : (c0 | (c1 << 8));
+    bool eq = oneLetter || (c1 && s[t+3] == '=');
+    uint8_t slot = apiParamSlot(key);
+    while (params.pos[slot] && params.key[slot] != key) slot = (slot +1) & (API_PARAM_SLOTS -1);
+    if (params.pos[slot]) continue; //the first occurrence counts
+    params.key[slot] = key;
+    params.pos[slot] = oneLetter ? t : t+1; //where indexOf("&K=") or indexOf("KK=") would find it
+    params.eq[slot] = eq;
+    n++;
+  }
+}
+
+//position of a parameter like req.indexOf(key), key is "KK=", "&K=" or "KK" for flags, -1 if not set
+int apiParam(const ApiParams& params, const __FlashStringHelper* key)
+{
+  PGM_P k = (PGM_P)key;
+  char c0 = pgm_read_byte(k);
+  if (c0 == '&') c0 = pgm_read_byte(++k);
+  char c1 = pgm_read_byte(k +1);
+  bool eq = (c1 == '=') || (c1 && pgm_read_byte(k +2) == '=');
+  uint16_t code = (c1 == '=' || !c1) ? c0 : (c0 | (c1 << 8));
+  uint8_t slot = apiParamSlot(code);
+  while (params.pos[slot]) {
+    if (params.key[slot] == code) return (eq && !params.eq[slot]) ? -1 : params.pos[slot];
+    slot = (slot +1) & (API_PARAM_SLOTS -1);
+  }
+  return -1;
+}
+
 
 //HTTP API request parser
 bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
@@ -454,6 +516,9 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   DEBUG_PRINT(F("API req: "));
   DEBUG_PRINTLN(req);
 
+  ApiParams params;
+  parseApiParams(req, params);
+
   strip.applyToAllSelected = false;
   //snapshot to check if request changed values later, temporary.
   byte prevCol[4] = {col[0], col[1], col[2], col[3]};
@@ -465,21 +530,21 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
 
   //segment select (sets main segment)
   byte prevMain = strip.getMainSegmentId();
-  pos = req.indexOf(F("SM="));
+  pos = apiParam(params, F("SM="));
   if (pos > 0) {
     strip.mainSegment = getNumVal(&req, pos);
   }
   byte selectedSeg = strip.getMainSegmentId();
   if (selectedSeg != prevMain) setValuesFromMainSeg();
 
-  pos = req.indexOf(F("SS="));
+  pos = apiParam(params, F("SS="));
   if (pos > 0) {
     byte t = getNumVal(&req, pos);
     if (t < strip.getMaxSegments()) selectedSeg = t;
   }
 
   WS2812FX::Segment& mainseg = strip.getSegment(selectedSeg);
-  pos = req.indexOf(F("SV=")); //segment selected
+  pos = apiParam(params, F("SV=")); //segment selected
   if (pos > 0) {
     byte t = getNumVal(&req, pos);
     if (t == 2) {
@@ -495,34 +560,34 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   uint16_t stopI = mainseg.stop;
   uint8_t grpI = mainseg.grouping;
   uint16_t spcI = mainseg.spacing;
-  pos = req.indexOf(F("&S=")); //segment start
+  pos = apiParam(params, F("&S=")); //segment start
   if (pos > 0) {
     startI = getNumVal(&req, pos);
   }
-  pos = req.indexOf(F("S2=")); //segment stop
+  pos = apiParam(params, F("S2=")); //segment stop
   if (pos > 0) {
     stopI = getNumVal(&req, pos);
   }
-  pos = req.indexOf(F("GP=")); //segment grouping
+  pos = apiParam(params, F("GP=")); //segment grouping
   if (pos > 0) {
     grpI = getNumVal(&req, pos);
     if (grpI == 0) grpI = 1;
   }
-  pos = req.indexOf(F("SP=")); //segment spacing
+  pos = apiParam(params, F("SP=")); //segment spacing
   if (pos > 0) {
     spcI = getNumVal(&req, pos);
   }
   strip.setSegment(selectedSeg, startI, stopI, grpI, spcI);
 
    //set presets
-  pos = req.indexOf(F("P1=")); //sets first preset for cycle
+  pos = apiParam(params, F("P1=")); //sets first preset for cycle
   if (pos > 0) presetCycleMin = getNumVal(&req, pos);
 
-  pos = req.indexOf(F("P2=")); //sets last preset for cycle
+  pos = apiParam(params, F("P2=")); //sets last preset for cycle
   if (pos > 0) presetCycleMax = getNumVal(&req, pos);
 
   //preset cycle
-  pos = req.indexOf(F("CY="));
+  pos = apiParam(params, F("CY="));
   if (pos > 0)
   {
     char cmd = req.charAt(pos+3);
@@ -531,36 +596,36 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
     presetCycCurr = presetCycleMin;
   }
 
-  pos = req.indexOf(F("PT=")); //sets cycle time in ms
+  pos = apiParam(params, F("PT=")); //sets cycle time in ms
   if (pos > 0) {
     int v = getNumVal(&req, pos);
     if (v > 100) presetCycleTime = v/100;
   }
 
-  pos = req.indexOf(F("PS=")); //saves current in preset
+  pos = apiParam(params, F("PS=")); //saves current in preset
   if (pos > 0) savePreset(getNumVal(&req, pos));
 
   //apply preset
-  if (updateVal(&req, "PL=", &presetCycCurr, presetCycleMin, presetCycleMax)) {
+  if (updateVal(&req, apiParam(params, F("PL=")), &presetCycCurr, presetCycleMin, presetCycleMax)) {
     applyPreset(presetCycCurr);
   }
 
   //set brightness
-  updateVal(&req, "&A=", &bri);
+  updateVal(&req, apiParam(params, F("&A=")), &bri);
 
   //set colors
-  updateVal(&req, "&R=", &col[0]);
-  updateVal(&req, "&G=", &col[1]);
-  updateVal(&req, "&B=", &col[2]);
-  updateVal(&req, "&W=", &col[3]);
-  updateVal(&req, "R2=", &colSec[0]);
-  updateVal(&req, "G2=", &colSec[1]);
-  updateVal(&req, "B2=", &colSec[2]);
-  updateVal(&req, "W2=", &colSec[3]);
+  updateVal(&req, apiParam(params, F("&R=")), &col[0]);
+  updateVal(&req, apiParam(params, F("&G=")), &col[1]);
+  updateVal(&req, apiParam(params, F("&B=")), &col[2]);
+  updateVal(&req, apiParam(params, F("&W=")), &col[3]);
+  updateVal(&req, apiParam(params, F("R2=")), &colSec[0]);
+  updateVal(&req, apiParam(params, F("G2=")), &colSec[1]);
+  updateVal(&req, apiParam(params, F("B2=")), &colSec[2]);
+  updateVal(&req, apiParam(params, F("W2=")), &colSec[3]);
 
   #ifdef WLED_ENABLE_LOXONE
   //lox parser
-  pos = req.indexOf(F("LX=")); // Lox primary color
+  pos = apiParam(params, F("LX=")); // Lox primary color
   if (pos > 0) {
     int lxValue = getNumVal(&req, pos);
     if (parseLx(lxValue, col)) {
@@ -568,7 +633,7 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
       nightlightActive = false; //always disable nightlight when toggling
     }
   }
-  pos = req.indexOf(F("LY=")); // Lox secondary color
+  pos = apiParam(params, F("LY=")); // Lox secondary color
   if (pos > 0) {
     int lxValue = getNumVal(&req, pos);
     if(parseLx(lxValue, colSec)) {
@@ -580,36 +645,36 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   #endif
 
   //set hue
-  pos = req.indexOf(F("HU="));
+  pos = apiParam(params, F("HU="));
   if (pos > 0) {
     uint16_t temphue = getNumVal(&req, pos);
     byte tempsat = 255;
-    pos = req.indexOf(F("SA="));
+    pos = apiParam(params, F("SA="));
     if (pos > 0) {
       tempsat = getNumVal(&req, pos);
     }
-    colorHStoRGB(temphue,tempsat,(req.indexOf(F("H2"))>0)? colSec:col);
+    colorHStoRGB(temphue,tempsat,(apiParam(params, F("H2"))>0)? colSec:col);
   }
 
   //set white spectrum (kelvin)
-  pos = req.indexOf(F("&K="));
+  pos = apiParam(params, F("&K="));
   if (pos > 0) {
-    colorKtoRGB(getNumVal(&req, pos),(req.indexOf(F("K2"))>0)? colSec:col);
+    colorKtoRGB(getNumVal(&req, pos),(apiParam(params, F("K2"))>0)? colSec:col);
   }
 
   //set color from HEX or 32bit DEC
-  pos = req.indexOf(F("CL="));
+  pos = apiParam(params, F("CL="));
   if (pos > 0) {
-    colorFromDecOrHexString(col, (char*)req.substring(pos + 3).c_str());
+    colorFromDecOrHexString(col, (char*)req.c_str() + pos + 3);
   }
-  pos = req.indexOf(F("C2="));
+  pos = apiParam(params, F("C2="));
   if (pos > 0) {
-    colorFromDecOrHexString(colSec, (char*)req.substring(pos + 3).c_str());
+    colorFromDecOrHexString(colSec, (char*)req.c_str() + pos + 3);
   }
-  pos = req.indexOf(F("C3="));
+  pos = apiParam(params, F("C3="));
   if (pos > 0) {
     byte t[4];
-    colorFromDecOrHexString(t, (char*)req.substring(pos + 3).c_str());
+    colorFromDecOrHexString(t, (char*)req.c_str() + pos + 3);
     if (selectedSeg != strip.getMainSegmentId()) {
       strip.applyToAllSelected = true;
       strip.setColor(2, t[0], t[1], t[2], t[3]);
@@ -619,13 +684,13 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   }
 
   //set to random hue SR=0->1st SR=1->2nd
-  pos = req.indexOf(F("SR"));
+  pos = apiParam(params, F("SR"));
   if (pos > 0) {
     _setRandomColor(getNumVal(&req, pos));
   }
 
   //swap 2nd & 1st
-  pos = req.indexOf(F("SC"));
+  pos = apiParam(params, F("SC"));
   if (pos > 0) {
     byte temp;
     for (uint8_t i=0; i<4; i++)
@@ -637,37 +702,37 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   }
 
   //set effect parameters
-  if (updateVal(&req, "FX=", &effectCurrent, 0, strip.getModeCount()-1)) presetCyclingEnabled = false;
-  updateVal(&req, "SX=", &effectSpeed);
-  updateVal(&req, "IX=", &effectIntensity);
-  updateVal(&req, "FP=", &effectPalette, 0, strip.getPaletteCount()-1);
+  if (updateVal(&req, apiParam(params, F("FX=")), &effectCurrent, 0, strip.getModeCount()-1)) presetCyclingEnabled = false;
+  updateVal(&req, apiParam(params, F("SX=")), &effectSpeed);
+  updateVal(&req, apiParam(params, F("IX=")), &effectIntensity);
+  updateVal(&req, apiParam(params, F("FP=")), &effectPalette, 0, strip.getPaletteCount()-1);
 
   //set advanced overlay
-  pos = req.indexOf(F("OL="));
+  pos = apiParam(params, F("OL="));
   if (pos > 0) {
     overlayCurrent = getNumVal(&req, pos);
   }
 
   //apply macro (deprecated, added for compatibility with pre-0.11 automations)
-  pos = req.indexOf(F("&M="));
+  pos = apiParam(params, F("&M="));
   if (pos > 0) {
     applyPreset(getNumVal(&req, pos) + 16);
   }
 
   //toggle send UDP direct notifications
-  pos = req.indexOf(F("SN="));
+  pos = apiParam(params, F("SN="));
   if (pos > 0) notifyDirect = (req.charAt(pos+3) != '0');
 
   //toggle receive UDP direct notifications
-  pos = req.indexOf(F("RN="));
+  pos = apiParam(params, F("RN="));
   if (pos > 0) receiveNotifications = (req.charAt(pos+3) != '0');
 
   //receive live data via UDP/Hyperion
-  pos = req.indexOf(F("RD="));
+  pos = apiParam(params, F("RD="));
   if (pos > 0) receiveDirect = (req.charAt(pos+3) != '0');
 
   //main toggle on/off (parse before nightlight, #1214)
-  pos = req.indexOf(F("&T="));
+  pos = apiParam(params, F("&T="));
   if (pos > 0) {
     nightlightActive = false; //always disable nightlight when toggling
     switch (getNumVal(&req, pos))
@@ -680,8 +745,8 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
 
   //toggle nightlight mode
   bool aNlDef = false;
-  if (req.indexOf(F("&ND")) > 0) aNlDef = true;
-  pos = req.indexOf(F("NL="));
+  if (apiParam(params, F("&ND")) > 0) aNlDef = true;
+  pos = apiParam(params, F("NL="));
   if (pos > 0)
   {
     if (req.charAt(pos+3) == '0')
@@ -699,14 +764,14 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   }
 
   //set nightlight target brightness
-  pos = req.indexOf(F("NT="));
+  pos = apiParam(params, F("NT="));
   if (pos > 0) {
     nightlightTargetBri = getNumVal(&req, pos);
     nightlightActiveOld = false; //re-init
   }
 
   //toggle nightlight fade
-  pos = req.indexOf(F("NF="));
+  pos = apiParam(params, F("NF="));
   if (pos > 0)
   {
     nightlightMode = getNumVal(&req, pos);
@@ -715,19 +780,19 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   }
   if (nightlightMode > NL_MODE_SUN) nightlightMode = NL_MODE_SUN;
 
-  pos = req.indexOf(F("TT="));
+  pos = apiParam(params, F("TT="));
   if (pos > 0) transitionDelay = getNumVal(&req, pos);
 
   //Segment reverse
-  pos = req.indexOf(F("RV="));
+  pos = apiParam(params, F("RV="));
   if (pos > 0) strip.getSegment(selectedSeg).setOption(SEG_OPTION_REVERSED, req.charAt(pos+3) != '0');
 
   //Segment reverse
-  pos = req.indexOf(F("MI="));
+  pos = apiParam(params, F("MI="));
   if (pos > 0) strip.getSegment(selectedSeg).setOption(SEG_OPTION_MIRROR, req.charAt(pos+3) != '0');
 
   //Segment brightness/opacity
-  pos = req.indexOf(F("SB="));
+  pos = apiParam(params, F("SB="));
   if (pos > 0) {
     byte segbri = getNumVal(&req, pos);
     strip.getSegment(selectedSeg).setOption(SEG_OPTION_ON, segbri, selectedSeg);
@@ -737,40 +802,40 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   }
 
   //set time (unix timestamp)
-  pos = req.indexOf(F("ST="));
+  pos = apiParam(params, F("ST="));
   if (pos > 0) {
     setTime(getNumVal(&req, pos));
   }
 
   //set countdown goal (unix timestamp)
-  pos = req.indexOf(F("CT="));
+  pos = apiParam(params, F("CT="));
   if (pos > 0) {
     countdownTime = getNumVal(&req, pos);
     if (countdownTime - now() > 0) countdownOverTriggered = false;
   }
 
-  pos = req.indexOf(F("LO="));
+  pos = apiParam(params, F("LO="));
   if (pos > 0) {
     realtimeOverride = getNumVal(&req, pos);
     if (realtimeOverride > 2) realtimeOverride = REALTIME_OVERRIDE_ALWAYS;
   }
 
-  pos = req.indexOf(F("RB"));
+  pos = apiParam(params, F("RB"));
   if (pos > 0) doReboot = true;
 
   //cronixie
   #ifndef WLED_DISABLE_CRONIXIE
   //mode, 1 countdown
-  pos = req.indexOf(F("NM="));
+  pos = apiParam(params, F("NM="));
   if (pos > 0) countdownMode = (req.charAt(pos+3) != '0');
   
-  pos = req.indexOf(F("NX=")); //sets digits to code
+  pos = apiParam(params, F("NX=")); //sets digits to code
   if (pos > 0) {
     strlcpy(cronixieDisplay, req.substring(pos + 3, pos + 9).c_str(), 6);
     setCronixie();
   }
 
-  pos = req.indexOf(F("NB="));
+  pos = apiParam(params, F("NB="));
   if (pos > 0) //sets backlight
   {
     cronixieBacklight = (req.charAt(pos+3) != '0');
@@ -778,12 +843,12 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   }
   #endif
 
-  pos = req.indexOf(F("U0=")); //user var 0
+  pos = apiParam(params, F("U0=")); //user var 0
   if (pos > 0) {
     userVar0 = getNumVal(&req, pos);
   }
 
-  pos = req.indexOf(F("U1=")); //user var 1
+  pos = apiParam(params, F("U1=")); //user var 1
   if (pos > 0) {
     userVar1 = getNumVal(&req, pos);
   }
@@ -834,12 +899,12 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   if (!apply) return true; //when called by JSON API, do not call colorUpdated() here
   
   //internal call, does not send XML response
-  pos = req.indexOf(F("IN"));
+  pos = apiParam(params, F("IN"));
   if (pos < 1) XML_response(request);
 
   strip.applyToAllSelected = false;
 
-  pos = req.indexOf(F("&NN")); //do not send UDP notifications this time
+  pos = apiParam(params, F("&NN")); //do not send UDP notifications this time
   colorUpdated((pos > 0) ? NOTIFIER_CALL_MODE_NO_NOTIFY : NOTIFIER_CALL_MODE_DIRECT_CHANGE);
 
   return true;
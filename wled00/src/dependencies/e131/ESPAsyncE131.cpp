@@ -44,6 +44,7 @@ bool ESPAsyncE131::begin(bool multicast, uint16_t port, uint16_t universe, uint8
   if (multicast) {
 		success = initMulticast(port, universe, n);
 	} else {
+    leaveMulticast();
     success = initUnicast(port);
 	}
 
@@ -66,29 +67,76 @@ bool ESPAsyncE131::initUnicast(uint16_t port) {
   return success;
 }
 
+// Listens on all addresses, so unicast and broadcast packets are still received, and joins the universes' groups
 bool ESPAsyncE131::initMulticast(uint16_t port, uint16_t universe, uint8_t n) {
-  bool success = false;
+  leaveMulticast();
+  if (!initUnicast(port)) return false;
+  joinMulticast(universe, n);
+  return true;
+}
 
-  IPAddress address = IPAddress(239, 255, ((universe >> 8) & 0xff),
-    ((universe >> 0) & 0xff));
+/////////////////////////////////////////////////////////
+//
+// Multicast group membership - Public
+//
+/////////////////////////////////////////////////////////
 
-  if (udp.listenMulticast(address, port)) {
-    ip4_addr_t ifaddr;
-    ip4_addr_t multicast_addr;
+ip4_addr_t ESPAsyncE131::multicastAddress(uint16_t universe) {
+  ip4_addr_t address;
+  address.addr = static_cast<uint32_t>(IPAddress(239, 255, ((universe >> 8) & 0xff), ((universe >> 0) & 0xff)));
+  return address;
+}
 
-    ifaddr.addr = static_cast<uint32_t>(Network.localIP());
-    for (uint8_t i = 1; i < n; i++) {
-        multicast_addr.addr = static_cast<uint32_t>(IPAddress(239, 255,
-          (((universe + i) >> 8) & 0xff), (((universe + i) >> 0)
-          & 0xff)));
-      igmp_joingroup(&ifaddr, &multicast_addr);
+// Joins the groups of universes universe to universe + n - 1 and leaves the ones no longer needed.
+// Returns the number of groups joined.
+uint8_t ESPAsyncE131::joinMulticast(uint16_t universe, uint8_t n) {
+  ip4_addr_t ifaddr;
+  ifaddr.addr = static_cast<uint32_t>(Network.localIP());
+  if (ifaddr.addr != _mcIf.addr) leaveMulticast(); // joined on a previous address
+
+  uint8_t joined[32] = {0};
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < _mcCount; i++) { // keep groups that are still needed
+    uint16_t u = _mcUniverse + i;
+    if (!(_mcJoined[i >> 3] & (1 << (i & 7)))) continue;
+    ip4_addr_t group = multicastAddress(u);
+    if (u >= universe && u - universe < n) {
+      joined[(u - universe) >> 3] |= 1 << ((u - universe) & 7);
+      count++;
+    } else {
+      igmp_leavegroup(&_mcIf, &group);
+    }
+  }
+  for (uint8_t i = 0; i < n; i++) {
+    if (joined[i >> 3] & (1 << (i & 7))) continue;
+    ip4_addr_t group = multicastAddress(universe + i);
+    if (igmp_joingroup(&ifaddr, &group) == ERR_OK) {
+      joined[i >> 3] |= 1 << (i & 7);
+      count++;
     }
+  }
 
-    udp.onPacket(std::bind(&ESPAsyncE131::parsePacket, this, std::placeholders::_1));
+  _mcIf = ifaddr;
+  _mcUniverse = universe;
+  _mcCount = n;
+  memcpy(_mcJoined, joined, sizeof(_mcJoined));
+  return count;
+}
 
-    success = true;
+void ESPAsyncE131::leaveMulticast() {
+  for (uint8_t i = 0; i < _mcCount; i++) {
+    if (!(_mcJoined[i >> 3] & (1 << (i & 7)))) continue;
+    ip4_addr_t group = multicastAddress(_mcUniverse + i);
+    igmp_leavegroup(&_mcIf, &group);
   }
-  return success;
+  _mcCount = 0;
+  memset(_mcJoined, 0, sizeof(_mcJoined));
+}
+
+bool ESPAsyncE131::multicastJoined(uint16_t universe) {
+  if (universe < _mcUniverse || universe - _mcUniverse >= _mcCount) return false;
+  uint8_t i = universe - _mcUniverse;
+  return _mcJoined[i >> 3] & (1 << (i & 7));
 }
 
 /////////////////////////////////////////////////////////
@@ -110,8 +158,15 @@ void ESPAsyncE131::parsePacket(AsyncUDPPacket _packet) {
 	if (protocol == P_ARTNET) {
 		if (memcmp(sbuff->art_id, ESPAsyncE131::ART_ID, sizeof(sbuff->art_id)))
 			error = true; //not "Art-Net"
-		if (sbuff->art_opcode != ARTNET_OPCODE_OPDMX)
+		if (sbuff->art_opcode == ARTNET_OPCODE_OPSYNC)
+			protocol = P_ARTNET_SYNC;
+		else if (sbuff->art_opcode != ARTNET_OPCODE_OPDMX)
 			error = true; //not a DMX packet
+	} else if (htonl(sbuff->root_vector) == ESPAsyncE131::VECTOR_ROOT_EXTENDED) {
+		if (htonl(sbuff->frame_vector) == ESPAsyncE131::VECTOR_FRAME_SYNC)
+			protocol = P_E131_SYNC;
+		else
+			error = true; //universe discovery is not supported
 	} else { //E1.31 error handling
 		if (htonl(sbuff->root_vector) != ESPAsyncE131::VECTOR_ROOT)
 			error = true;
@@ -129,6 +184,7 @@ void ESPAsyncE131::parsePacket(AsyncUDPPacket _packet) {
   }
 
   if (!error) {
-    _callback(sbuff, _packet.remoteIP(), protocol);
+    _remotePort = _packet.remotePort();
+    _callback(sbuff, _packet.remoteIP(), protocol, _packet.length());
   }
 }
\ No newline at end of file
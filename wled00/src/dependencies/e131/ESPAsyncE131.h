@@ -50,14 +50,40 @@ typedef struct ip_addr ip4_addr_t;
 #define ARTNET_DEFAULT_PORT 6454
 #define DDP_DEFAULT_PORT    4048
 
+#define E131_DATA_OFFSET 125   // offset of property_values (start code) in an E1.31 packet
+#define ARTNET_DATA_OFFSET 18  // offset of art_data in an Art-Net packet
+
+#define DDP_HEADER_LEN 10
+#define DDP_MAX_DATALEN 1440
+
 #define DDP_PUSH_FLAG 0x01
+#define DDP_QUERY_FLAG 0x02
+#define DDP_REPLY_FLAG 0x04
+#define DDP_STORAGE_FLAG 0x08
 #define DDP_TIMECODE_FLAG 0x10
+#define DDP_VERSION_1 0x40
+
+//data type: bits 5-3 type, bits 2-0 bits per element
+#define DDP_TYPE(t) (((t) >> 3) & 0x07)
+#define DDP_TYPE_RGB  1
+#define DDP_TYPE_RGBW 3
+#define DDP_SIZE(t) ((t) & 0x07)
+#define DDP_SIZE_8BIT 3
+
+//destination ids
+#define DDP_ID_DISPLAY 1
+#define DDP_ID_CONFIG  250
+#define DDP_ID_STATUS  251
+#define DDP_ID_ALL     255
 
 #define ARTNET_OPCODE_OPDMX 0x5000
+#define ARTNET_OPCODE_OPSYNC 0x5200
 
 #define P_E131   0
 #define P_ARTNET 1
 #define P_DDP    2
+#define P_E131_SYNC   3 // E1.31 universe synchronization packet
+#define P_ARTNET_SYNC 4 // ArtSync packet
 
 // E1.31 Packet Offsets
 #define E131_ROOT_PREAMBLE_SIZE 0
@@ -76,6 +102,12 @@ typedef struct ip_addr ip4_addr_t;
 #define E131_FRAME_OPT 112
 #define E131_FRAME_UNIVERSE 113
 
+// E1.31 Synchronization Packet Offsets
+#define E131_SYNC_SEQ 44
+#define E131_SYNC_ADDR 45
+#define E131_SYNC_LEN 47  // sync packet up to and including the synchronization address
+#define ARTNET_SYNC_LEN 14 // ArtSync: ID, opcode, protocol version, 2 aux bytes
+
 #define E131_DMP_FLENGTH 115
 #define E131_DMP_VECTOR 117
 #define E131_DMP_TYPE 118
@@ -100,7 +132,7 @@ typedef union {
       uint32_t frame_vector;
       uint8_t  source_name[64];
       uint8_t  priority;
-      uint16_t reserved;
+      uint16_t reserved;        // synchronization address since E1.31-2016
       uint8_t  sequence_number;
       uint8_t  options;
       uint16_t universe;
@@ -134,10 +166,10 @@ typedef union {
     uint8_t destination;
     uint32_t channelOffset;
     uint16_t dataLen;
-    uint8_t data[1];
+    uint8_t data[1]; //preceded by a 32 bit timecode if DDP_TIMECODE_FLAG is set
   } __attribute__((packed));
 
-  /*struct { //DDP Time code Header (unsupported)
+  /*struct { //DDP Time code Header (timecode read from data[0-3])
     uint8_t flags;
     uint8_t sequenceNum;
     uint8_t dataType;
@@ -152,7 +184,7 @@ typedef union {
 } e131_packet_t;
 
 // new packet callback
-typedef void (*e131_packet_callback_function) (e131_packet_t* p, IPAddress clientIP, byte protocol);
+typedef void (*e131_packet_callback_function) (e131_packet_t* p, IPAddress clientIP, byte protocol, uint16_t len);
 
 class ESPAsyncE131 {
  private:
@@ -162,10 +194,20 @@ class ESPAsyncE131 {
     static const uint32_t VECTOR_ROOT = 4;
     static const uint32_t VECTOR_FRAME = 2;
     static const uint8_t VECTOR_DMP = 2;
+    static const uint32_t VECTOR_ROOT_EXTENDED = 8;
+    static const uint32_t VECTOR_FRAME_SYNC = 1;
 
     e131_packet_t   *sbuff;     // Pointer to scratch packet buffer
     AsyncUDP        udp;        // AsyncUDP
 
+    // Joined multicast groups 239.255.hi.lo of universes _mcUniverse to _mcUniverse + _mcCount - 1
+    ip4_addr_t      _mcIf = {};
+    uint16_t        _mcUniverse = 0;
+    uint8_t         _mcCount = 0;
+    uint8_t         _mcJoined[32] = {0};  // bit per universe, set if the IGMP join succeeded
+
+    static ip4_addr_t multicastAddress(uint16_t universe);
+
     // Internal Initializers
     bool initUnicast(uint16_t port);
     bool initMulticast(uint16_t port, uint16_t universe, uint8_t n = 1);
@@ -174,12 +216,23 @@ class ESPAsyncE131 {
     void parsePacket(AsyncUDPPacket _packet);
     
     e131_packet_callback_function _callback = nullptr;
+    uint16_t        _remotePort = 0;
 
  public:
     ESPAsyncE131(e131_packet_callback_function callback);
 
     // Generic UDP listener, no physical or IP configuration
     bool begin(bool multicast, uint16_t port = E131_DEFAULT_PORT, uint16_t universe = 1, uint8_t n = 1);
+
+    // Multicast group membership, can be changed while listening
+    uint8_t joinMulticast(uint16_t universe, uint8_t n = 1);
+    void leaveMulticast();
+    bool multicastJoined(uint16_t universe);
+    uint16_t multicastUniverse() { return _mcUniverse; }
+    uint8_t multicastCount() { return _mcCount; }
+
+    // Source port of the packet passed to the callback, valid while it runs
+    uint16_t remotePort() { return _remotePort; }
 };
 
 #endif  // ESPASYNCE131_H_
\ No newline at end of file
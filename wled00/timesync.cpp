@@ -0,0 +1,69 @@
+#include "wled.h"
+
+/*
+ * Effect clock synchronization between WLED nodes, the clock math is in timesync.h
+ * Requests go to the node this one receives sync notifications from, on udpPort2.
+ */
+
+uint32_t timeSyncExpectedTimebase = 0;  //to notice when the timebase was set elsewhere
+
+static uint32_t effectClock()
+{
+  return millis() + strip.timebase;
+}
+
+static void adjustTimebase(int32_t ms)
+{
+  strip.timebase += ms;
+  timeSyncExpectedTimebase = strip.timebase;
+}
+
+//the node whose notifications are received is the clock reference
+void timeSyncSetReference(IPAddress ip)
+{
+  timeSync.setReference(ip);
+}
+
+//true if the timebase is synchronized with this node, so the coarse timebase of its notifications is not needed
+bool timeSyncLocked(IPAddress ip)
+{
+  return timeSyncEnabled && udp2Connected && timeSync.locked(ip);
+}
+
+//call from loop()
+void handleTimeSync()
+{
+  if (!timeSyncEnabled || !udp2Connected || !timeSync.ref) return;
+
+  if (strip.timebase != timeSyncExpectedTimebase) { //effect restarted or coarse sync
+    timeSync.reset();
+    timeSyncExpectedTimebase = strip.timebase;
+  }
+
+  int8_t step = timeSync.slew(millis());
+  if (step) adjustTimebase(step);
+
+  byte out[TIMESYNC_REQUEST_LEN];
+  if (!timeSync.request(millis(), effectClock(), out)) return;
+  notifier2Udp.beginPacket(IPAddress(timeSync.ref), udpPort2);
+  notifier2Udp.write(out, sizeof(out));
+  notifier2Udp.endPacket();
+}
+
+void handleTimeSyncPacket(const byte* udpIn, uint16_t len, IPAddress ip, uint16_t port)
+{
+  if (udpIn[1] == TIMESYNC_REQUEST) { //answered by every node
+    byte out[TIMESYNC_RESPONSE_LEN];
+    uint8_t outLen = timeSync.respond(udpIn, len, ip, effectClock(), out);
+    if (!outLen) return;
+    notifier2Udp.beginPacket(ip, port);
+    notifier2Udp.write(out, outLen);
+    notifier2Udp.endPacket();
+    return;
+  }
+
+  //response
+  if (!timeSyncEnabled) return;
+  int32_t step = timeSync.receive(udpIn, len, ip, Network.localIP(), effectClock());
+  if (step) adjustTimebase(step);
+}
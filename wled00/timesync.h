@@ -0,0 +1,151 @@
+#ifndef WLED_TIMESYNC_H
+#define WLED_TIMESYNC_H
+
+/*
+ * Effect clock synchronization between WLED nodes, the packets are sent and received by timesync.cpp
+ * NTP style request/response with the node this one receives sync notifications from.
+ * The offset of the sample with the lowest round trip time is slewed into strip.timebase 1ms at a time.
+ * If two nodes are each other's reference, the one with the lower IP leads and only the other one adjusts.
+ */
+
+#include "const.h"
+#include <Arduino.h>
+
+#define TIMESYNC_REQUEST      2
+#define TIMESYNC_RESPONSE     3
+#define TIMESYNC_REQUEST_LEN  7
+#define TIMESYNC_RESPONSE_LEN 16
+
+//request:  0: 255, 1: TIMESYNC_REQUEST,  2: seq, 3-6: t0 (requester's effect clock at send)
+//response: 0: 255, 1: TIMESYNC_RESPONSE, 2: seq, 3-6: t0, 7-10: t1 (responder's clock at receive), 11-14: t2 (at send),
+//15: 1 if the responder uses the requester as its reference (missing in responses of older versions)
+
+class TimeSync {
+  public:
+    uint32_t ref = 0;       //IP of the reference node (last notification sender), 0 = none
+    int32_t offset = 0;     //reference effect clock - own effect clock, ms
+    uint32_t rtt = 0;       //round trip time of the best sample, ms
+    int32_t error = -1;     //estimated max. effect clock error, ms (-1 = not synced)
+    uint8_t numSamples = 0;
+    bool leading = false;   //the reference follows this node, so this node keeps its clock
+
+    void reset() {
+      numSamples = 0;
+      _next = 0;
+      _pending = 0;
+      error = -1;
+    }
+
+    void setReference(uint32_t ip) {
+      if (ip == ref) return;
+      ref = ip;
+      leading = false;
+      reset();
+    }
+
+    //true if the timebase is synchronized with this node (or leads it), so the coarse timebase of its notifications is not needed
+    bool locked(uint32_t ip) {
+      return ref && ip == ref && (leading || numSamples >= TIMESYNC_MIN_SAMPLES);
+    }
+
+    //ms to move the own timebase by now, one step of the pending offset at a time
+    int8_t slew(uint32_t now) {
+      if (!_pending || now - _lastSlew < TIMESYNC_SLEW_INTERVAL) return 0;
+      int8_t step = (_pending > 0) ? 1 : -1;
+      _adjust(step);
+      offset -= step;
+      _pending -= step;
+      _lastSlew = now;
+      return step;
+    }
+
+    //writes a request to the reference into out if one is due, returns its length
+    uint8_t request(uint32_t now, uint32_t clock, byte* out) {
+      if (!ref || now - _lastRequest < TIMESYNC_INTERVAL) return 0;
+      _lastRequest = now;
+      out[0] = 255;
+      out[1] = TIMESYNC_REQUEST;
+      out[2] = ++_seq;
+      _write(out +3, clock);
+      return TIMESYNC_REQUEST_LEN;
+    }
+
+    //answers a request of node ip (every node does), returns the length written to out
+    uint8_t respond(const byte* in, uint16_t len, uint32_t ip, uint32_t clock, byte* out) {
+      if (len < TIMESYNC_REQUEST_LEN) return 0;
+      out[0] = 255;
+      out[1] = TIMESYNC_RESPONSE;
+      out[2] = in[2];
+      memcpy(out +3, in +3, 4);
+      _write(out +7, clock);
+      _write(out +11, clock);
+      out[15] = (ip == ref);
+      return TIMESYNC_RESPONSE_LEN;
+    }
+
+    //processes a response of node ip, returns ms to move the own timebase by at once
+    int32_t receive(const byte* in, uint16_t len, uint32_t ip, uint32_t ownIp, uint32_t clock) {
+      if (len < TIMESYNC_RESPONSE_LEN -1 || ip != ref || in[2] != _seq) return 0;
+      bool mutual = len >= TIMESYNC_RESPONSE_LEN && in[15];
+      leading = mutual && ownIp < ip;
+      if (leading) { //the reference adjusts to us, adjusting to it as well would make both drift
+        reset();
+        return 0;
+      }
+      uint32_t t0 = _read(in +3), t1 = _read(in +7), t2 = _read(in +11);
+      int32_t sampleRtt = (int32_t)(clock - t0) - (int32_t)(t2 - t1);
+      if (sampleRtt < 0) sampleRtt = 0;
+      if (sampleRtt > TIMESYNC_MAX_RTT) return 0; //delayed on the way, useless for the offset
+
+      Sample &s = _samples[_next];
+      s.offset = ((int32_t)(t1 - t0) + (int32_t)(t2 - clock)) / 2;
+      s.rtt = sampleRtt;
+      _next = (_next +1) % TIMESYNC_SAMPLES;
+      if (numSamples < TIMESYNC_SAMPLES) numSamples++;
+
+      //the sample with the lowest round trip time has the least asymmetric delay
+      Sample* best = &_samples[0];
+      for (uint8_t i = 1; i < numSamples; i++) {
+        if (_samples[i].rtt < best->rtt) best = &_samples[i];
+      }
+      offset = best->offset;
+      rtt = best->rtt;
+
+      int32_t step = 0;
+      if (offset > TIMESYNC_STEP || offset < -TIMESYNC_STEP) { //too far off to slew
+        step = offset;
+        numSamples = 0;
+        _next = 0;
+        _pending = 0;
+      } else {
+        _pending = offset;
+      }
+      error = (_pending < 0 ? -_pending : _pending) + (rtt +1) /2;
+      return step;
+    }
+
+  private:
+    struct Sample {
+      int32_t offset;
+      uint32_t rtt;    //without the time spent in the responder
+    };
+    Sample _samples[TIMESYNC_SAMPLES];
+    uint8_t _next = 0;
+    uint8_t _seq = 0;
+    int32_t _pending = 0;   //ms still to slew into the timebase
+    uint32_t _lastRequest = 0;
+    uint32_t _lastSlew = 0;
+
+    //the stored samples were measured against the clock before the timebase moved by ms
+    void _adjust(int32_t ms) {
+      for (uint8_t i = 0; i < numSamples; i++) _samples[i].offset -= ms;
+    }
+    static void _write(byte* p, uint32_t v) {
+      p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+    }
+    static uint32_t _read(const byte* p) {
+      return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+    }
+};
+
+#endif
@@ -7,6 +7,31 @@
 #define WLEDPACKETSIZE 29
 #define UDP_IN_MAXSIZE 1472
 
+//segment sync (notifier v2) packet: 0: SYNC_V2_PACKET, 1: version, 2: sequence number, 3: call mode, 4: bri,
+//5-6: transition (LE), 7-10: timebase, 11: nightlight on, 12: nightlight duration, 13: main segment, 14: record count
+//each record: segment id, 2 byte field mask, then the fields in mask bit order
+#define SYNC_V2_PACKET        0x10
+#define SYNC_V2_VERSION       2
+#define SYNC_V2_HEADER_LEN    15
+#define SYNC_V2_FULL_INTERVAL 8      // every n-th packet carries all fields of all segments
+#define SYNC_V2_FULL_TIMEOUT  5000   // ms after a partial packet until all fields are sent again (repairs lost packets)
+#define SYNC_SEG_BOUNDS       0x0001 // start, stop (2 bytes each, BE), stop 0 deletes the segment
+#define SYNC_SEG_GROUPING     0x0002 // grouping, spacing
+#define SYNC_SEG_OPTIONS      0x0004 // on, reverse, mirror bits of Segment.options
+#define SYNC_SEG_OPACITY      0x0008
+#define SYNC_SEG_MODE         0x0010
+#define SYNC_SEG_SPEED        0x0020
+#define SYNC_SEG_INTENSITY    0x0040
+#define SYNC_SEG_PALETTE      0x0080
+#define SYNC_SEG_COLOR        0x0100 // bits 8-10: colors 0-2 (4 bytes each, WRGB)
+#define SYNC_SEG_OPTION_MASK  (SEGMENT_ON | REVERSE | MIRROR)
+#define SYNC_SEG_MAX_LEN      27     // id, mask and all fields
+
+#define DRLE_HEADER_LEN     6
+#define DRLE_FLAG_KEYFRAME  0x01 // does not depend on the previous frame
+#define DRLE_FLAG_RGBW      0x02 // 4 bytes per pixel
+#define DRLE_FLAG_PUSH      0x04 // last packet of the frame
+
 void notify(byte callMode, bool followUp)
 {
   if (!udpConnected) return;
@@ -22,6 +47,10 @@ void notify(byte callMode, bool followUp)
     case NOTIFIER_CALL_MODE_ALEXA:         if (!notifyAlexa)  return; break;
     default: return;
   }
+  if (notifySegments) { //sent once, receivers catch up with the next full packet
+    notifySegmentSync(callMode);
+    return;
+  }
   byte udpOut[WLEDPACKETSIZE];
   udpOut[0] = 0; //0: wled notifier protocol 1: WARLS protocol
   udpOut[1] = callMode;
@@ -72,6 +101,202 @@ void notify(byte callMode, bool followUp)
 }
 
 
+/*********************************************************************************************\
+   Segment sync (notifier v2): changed fields of each segment, applied without JSON parsing
+\*********************************************************************************************/
+WS2812FX::Segment syncSegSent[MAX_NUM_SEGMENTS]; //state of each segment when it was last sent
+byte syncSeq = 0;
+byte syncLastSeq = 0;
+IPAddress syncLastIP;
+unsigned long syncLastFull = 0; //millis() the last packet with all fields was sent
+bool syncPartialSent = false;   //receivers that lost a packet since then are out of date
+
+static uint8_t syncFieldsLen(uint16_t mask)
+{
+  uint8_t len = 0;
+  if (mask & SYNC_SEG_BOUNDS)   len += 4;
+  if (mask & SYNC_SEG_GROUPING) len += 2;
+  for (uint16_t b = SYNC_SEG_OPTIONS; b <= SYNC_SEG_PALETTE; b <<= 1) if (mask & b) len++;
+  for (uint8_t i = 0; i < 3; i++) if (mask & (SYNC_SEG_COLOR << i)) len += 4;
+  return len;
+}
+
+static uint16_t syncSegChanges(WS2812FX::Segment& seg, WS2812FX::Segment& sent, bool full)
+{
+  uint16_t mask = 0;
+  if (full || seg.start != sent.start || seg.stop != sent.stop) mask |= SYNC_SEG_BOUNDS;
+  if (!seg.isActive()) return mask; //deleted segments only need their bounds
+  if (full || !sent.isActive()) return 0x07FF;
+  if (seg.grouping != sent.grouping || seg.spacing != sent.spacing) mask |= SYNC_SEG_GROUPING;
+  if ((seg.options ^ sent.options) & SYNC_SEG_OPTION_MASK) mask |= SYNC_SEG_OPTIONS;
+  if (seg.opacity != sent.opacity)     mask |= SYNC_SEG_OPACITY;
+  if (seg.mode != sent.mode)           mask |= SYNC_SEG_MODE;
+  if (seg.speed != sent.speed)         mask |= SYNC_SEG_SPEED;
+  if (seg.intensity != sent.intensity) mask |= SYNC_SEG_INTENSITY;
+  if (seg.palette != sent.palette)     mask |= SYNC_SEG_PALETTE;
+  for (uint8_t i = 0; i < 3; i++) if (seg.colors[i] != sent.colors[i]) mask |= SYNC_SEG_COLOR << i;
+  return mask;
+}
+
+void notifySegmentSync(byte callMode)
+{
+  byte out[SYNC_V2_HEADER_LEN + MAX_NUM_SEGMENTS * SYNC_SEG_MAX_LEN];
+  syncSeq++;
+  bool full = (syncSeq % SYNC_V2_FULL_INTERVAL) == 1 || millis() - syncLastFull > SYNC_V2_FULL_TIMEOUT;
+  if (full) syncLastFull = millis();
+  syncPartialSent = !full;
+
+  out[0] = SYNC_V2_PACKET;
+  out[1] = SYNC_V2_VERSION;
+  out[2] = syncSeq;
+  out[3] = callMode;
+  out[4] = bri;
+  out[5] = (transitionDelay >> 0) & 0xFF;
+  out[6] = (transitionDelay >> 8) & 0xFF;
+  uint32_t t = millis() + strip.timebase;
+  out[7]  = (t >> 24) & 0xFF;
+  out[8]  = (t >> 16) & 0xFF;
+  out[9]  = (t >>  8) & 0xFF;
+  out[10] = (t >>  0) & 0xFF;
+  out[11] = nightlightActive;
+  out[12] = nightlightDelayMins;
+  out[13] = strip.getMainSegmentId();
+
+  uint16_t pos = SYNC_V2_HEADER_LEN;
+  byte n = 0;
+  for (byte id = 0; id < strip.getMaxSegments(); id++) {
+    WS2812FX::Segment& seg = strip.getSegment(id);
+    uint16_t mask = syncSegChanges(seg, syncSegSent[id], full);
+    if (!mask) continue;
+    out[pos++] = id;
+    out[pos++] = mask >> 8;
+    out[pos++] = mask & 0xFF;
+    if (mask & SYNC_SEG_BOUNDS) {
+      out[pos++] = seg.start >> 8; out[pos++] = seg.start & 0xFF;
+      out[pos++] = seg.stop  >> 8; out[pos++] = seg.stop  & 0xFF;
+    }
+    if (mask & SYNC_SEG_GROUPING) { out[pos++] = seg.grouping; out[pos++] = seg.spacing; }
+    if (mask & SYNC_SEG_OPTIONS)   out[pos++] = seg.options & SYNC_SEG_OPTION_MASK;
+    if (mask & SYNC_SEG_OPACITY)   out[pos++] = seg.opacity;
+    if (mask & SYNC_SEG_MODE)      out[pos++] = seg.mode;
+    if (mask & SYNC_SEG_SPEED)     out[pos++] = seg.speed;
+    if (mask & SYNC_SEG_INTENSITY) out[pos++] = seg.intensity;
+    if (mask & SYNC_SEG_PALETTE)   out[pos++] = seg.palette;
+    for (uint8_t i = 0; i < 3; i++) {
+      if (!(mask & (SYNC_SEG_COLOR << i))) continue;
+      uint32_t c = seg.colors[i];
+      out[pos++] = c >> 24; out[pos++] = c >> 16; out[pos++] = c >> 8; out[pos++] = c;
+    }
+    syncSegSent[id] = seg;
+    n++;
+  }
+  out[14] = n;
+
+  IPAddress broadcastIp;
+  broadcastIp = ~uint32_t(Network.subnetMask()) | uint32_t(Network.gatewayIP());
+
+  notifierUdp.beginPacket(broadcastIp, udpPort);
+  notifierUdp.write(out, pos);
+  notifierUdp.endPacket();
+  notificationSentCallMode = callMode;
+  notificationSentTime = millis();
+  notificationTwoRequired = false;
+}
+
+//resends all fields a while after the last partial packet, receivers that lost one do not wait for the next change
+static void handleSegmentSyncRefresh()
+{
+  if (!syncPartialSent || !notifySegments || !udpConnected) return;
+  if (millis() - syncLastFull > SYNC_V2_FULL_TIMEOUT) notifySegmentSync(notificationSentCallMode);
+}
+
+void handleSegmentSync(const uint8_t* udpIn, uint16_t len, IPAddress ip)
+{
+  if (len < SYNC_V2_HEADER_LEN || udpIn[1] != SYNC_V2_VERSION) return;
+  if (realtimeMode || !receiveNotifications) return;
+  //ignore notification if received within a second after sending a notification ourselves
+  if (millis() - notificationSentTime < 1000) return;
+  if (ip == syncLastIP && udpIn[2] == syncLastSeq) return; //same packet received twice
+  syncLastIP = ip;
+  syncLastSeq = udpIn[2];
+  timeSyncSetReference(ip);
+
+  bool someSel = (receiveNotificationBrightness || receiveNotificationColor || receiveNotificationEffects);
+  bool applyBri = receiveNotificationBrightness || !someSel;
+  bool applyCol = receiveNotificationColor || !someSel;
+  bool applyFx  = receiveNotificationEffects || !someSel;
+
+  if (applyFx) {
+    transitionDelayTemp = udpIn[5] | (udpIn[6] << 8);
+    if (!timeSyncLocked(ip)) {
+      uint32_t t = (udpIn[7] << 24) | (udpIn[8] << 16) | (udpIn[9] << 8) | (udpIn[10]);
+      t += 2;
+      t -= millis();
+      strip.timebase = t;
+    }
+    if (udpIn[13] < strip.getMaxSegments()) strip.mainSegment = udpIn[13];
+  }
+  strip.setTransition(transitionDelayTemp);
+
+  uint16_t pos = SYNC_V2_HEADER_LEN;
+  for (byte r = 0; r < udpIn[14]; r++) {
+    if (pos + 3 > len) break;
+    byte id = udpIn[pos];
+    uint16_t mask = (udpIn[pos +1] << 8) | udpIn[pos +2];
+    pos += 3;
+    const uint8_t* f = udpIn + pos;
+    pos += syncFieldsLen(mask);
+    if (pos > len) break; //truncated
+    if (id >= strip.getMaxSegments()) continue;
+    WS2812FX::Segment& seg = strip.getSegment(id);
+
+    if (applyFx && (mask & (SYNC_SEG_BOUNDS | SYNC_SEG_GROUPING))) {
+      uint16_t start = seg.start, stop = seg.stop;
+      uint8_t grp = seg.grouping, spc = seg.spacing;
+      if (mask & SYNC_SEG_BOUNDS) {
+        start = (f[0] << 8) | f[1]; stop = (f[2] << 8) | f[3]; f += 4;
+      }
+      if (mask & SYNC_SEG_GROUPING) { grp = f[0]; spc = f[1]; f += 2; }
+      strip.setSegment(id, start, stop, grp, spc);
+    } else {
+      if (mask & SYNC_SEG_BOUNDS) f += 4;
+      if (mask & SYNC_SEG_GROUPING) f += 2;
+    }
+    if (mask & SYNC_SEG_OPTIONS) {
+      if (applyFx) seg.options = (seg.options & ~SYNC_SEG_OPTION_MASK) | (*f & SYNC_SEG_OPTION_MASK);
+      f++;
+    }
+    if (mask & SYNC_SEG_OPACITY) { if (applyBri) seg.setOpacity(*f, id); f++; }
+    if (mask & SYNC_SEG_MODE) {
+      if (applyFx && *f != seg.mode && *f < strip.getModeCount()) strip.setMode(id, *f);
+      f++;
+    }
+    if (mask & SYNC_SEG_SPEED)     { if (applyFx) seg.speed = *f; f++; }
+    if (mask & SYNC_SEG_INTENSITY) { if (applyFx) seg.intensity = *f; f++; }
+    if (mask & SYNC_SEG_PALETTE)   { if (applyFx && *f < strip.getPaletteCount()) seg.palette = *f; f++; }
+    for (uint8_t i = 0; i < 3; i++) {
+      if (!(mask & (SYNC_SEG_COLOR << i))) continue;
+      if (applyCol) seg.setColor(i, ((uint32_t)f[0] << 24) | ((uint32_t)f[1] << 16) | ((uint32_t)f[2] << 8) | f[3], id);
+      f += 4;
+    }
+  }
+
+  if (applyFx) {
+    nightlightActive = udpIn[11];
+    if (nightlightActive) nightlightDelayMins = udpIn[12];
+  }
+  if (applyBri) bri = udpIn[4];
+  //segments are set already, colorUpdated() only picks up brightness and the main segment
+  strip.applyToAllSelected = false;
+  setValuesFromMainSeg();
+  strip.trigger();
+  uint32_t timebase = strip.timebase; //do not restart effects when turned on, the sender's clock is used
+  colorUpdated(NOTIFIER_CALL_MODE_NO_NOTIFY);
+  strip.timebase = timebase;
+  interfaceUpdateCallMode = NOTIFIER_CALL_MODE_NOTIFICATION;
+}
+
+
 void realtimeLock(uint32_t timeoutMs, byte md)
 {
   if (!realtimeMode && !realtimeOverride){
@@ -106,12 +331,21 @@ void handleNotifications()
   if(udpConnected && notificationTwoRequired && millis()-notificationSentTime > 250){
     notify(notificationSentCallMode,true);
   }
+  handleSegmentSyncRefresh();
   
-  if (e131NewData && millis() - strip.getLastShow() > 15)
+  //E1.31 / Art-Net frames, shown once each without the rate limit below
+  handleE131Frame();
+  //DDP frames scheduled by timecode and query replies
+  handleDDPReply();
+
+  if (e131NewData && (realtimeBuffered() || millis() - strip.getLastShow() > 15))
   {
     e131NewData = false;
-    strip.show();
+    realtimeShow();
   }
+  handleRealtimeBuffer();
+  handleRealtimeStats();
+  handleTimeSync();
 
   //unlock strip when realtime UDP times out
   if (realtimeMode && millis() > realtimeTimeout)
@@ -124,8 +358,27 @@ void handleNotifications()
 
   //receive UDP notifications
   if (!udpConnected) return;
-    
+
+  //drain all pending packets, bounded so the rest of the loop keeps running with a flooded socket
+  unsigned long drainStart = micros();
+  uint8_t n = 0;
+  while (handleUdpPacket()) {
+    n++;
+    if (n >= UDP_DRAIN_MAX_PACKETS || micros() - drainStart > UDP_DRAIN_MAX_US) {
+      udpRxDeferred++; //there might be packets left, continue next loop
+      break;
+    }
+  }
+  udpRxPackets += n;
+  udpRxDepth = n;
+  if (n > udpRxMaxDepth) udpRxMaxDepth = n;
+}
+
+//handles one packet from the notifier or realtime sockets, false if none was pending
+bool handleUdpPacket()
+{
   bool isSupp = false;
+  unsigned long rxStart = micros();
   uint16_t packetSize = notifierUdp.parsePacket();
   if (!packetSize && udp2Connected) {
     packetSize = notifier2Udp.parsePacket();
@@ -136,31 +389,29 @@ void handleNotifications()
   if (!packetSize && udpRgbConnected) {
     packetSize = rgbUdp.parsePacket();
     if (packetSize) {
-      if (!receiveDirect) return;
-      if (packetSize > UDP_IN_MAXSIZE || packetSize < 3) return;
+      if (!receiveDirect || packetSize > UDP_IN_MAXSIZE || packetSize < 3) {
+        if (receiveDirect) rtStats[REALTIME_MODE_HYPERION].badLen++;
+        udpRxRejected++; return true;
+      }
       realtimeIP = rgbUdp.remoteIP();
       DEBUG_PRINTLN(rgbUdp.remoteIP());
       uint8_t lbuf[packetSize];
       rgbUdp.read(lbuf, packetSize);
       realtimeLock(realtimeTimeoutMs, REALTIME_MODE_HYPERION);
-      if (realtimeOverride) return;
-      uint16_t id = 0;
-      for (uint16_t i = 0; i < packetSize -2; i += 3)
-      {
-        setRealtimePixel(id, lbuf[i], lbuf[i+1], lbuf[i+2], 0);
-        
-        id++; if (id >= ledCount) break;
-      }
-      strip.show();
-      return;
+      if (realtimeOverride) return true;
+      setRealtimePixels(0, lbuf, packetSize /3, 3);
+      rtStatPacket(REALTIME_MODE_HYPERION, packetSize, rxStart);
+      realtimeShow();
+      return true;
     } 
   }
+  if (!packetSize) return false;
 
-  if (!(receiveNotifications || receiveDirect)) return;
-  
   //notifier and UDP realtime
-  if (!packetSize || packetSize > UDP_IN_MAXSIZE) return;
-  if (!isSupp && notifierUdp.remoteIP() == Network.localIP()) return; //don't process broadcasts we send ourselves
+  if (!(receiveNotifications || receiveDirect) || packetSize > UDP_IN_MAXSIZE) {
+    udpRxRejected++; return true;
+  }
+  if (!isSupp && notifierUdp.remoteIP() == Network.localIP()) return true; //don't process broadcasts we send ourselves
 
   uint8_t udpIn[packetSize +1];
   uint16_t len;
@@ -169,7 +420,7 @@ void handleNotifications()
 
   // WLED nodes info notifications
   if (isSupp && udpIn[0] == 255 && udpIn[1] == 1 && len >= 40) {
-    if (!nodeListEnabled || notifier2Udp.remoteIP() == Network.localIP()) return;
+    if (!nodeListEnabled || notifier2Udp.remoteIP() == Network.localIP()) return true;
 
     uint8_t unit = udpIn[39];
     NodesMap::iterator it = Nodes.find(unit);
@@ -195,15 +446,29 @@ void handleNotifications()
           build |= udpIn[40+i]<<(8*i);
       it->second.build = build;
     }
-    return;
+    return true;
+  }
+
+  //effect clock sync
+  if (isSupp && udpIn[0] == 255 && (udpIn[1] == TIMESYNC_REQUEST || udpIn[1] == TIMESYNC_RESPONSE) && len >= TIMESYNC_REQUEST_LEN) {
+    handleTimeSyncPacket(udpIn, len, notifier2Udp.remoteIP(), notifier2Udp.remotePort());
+    return true;
+  }
+
+  //segment sync
+  if (udpIn[0] == SYNC_V2_PACKET) {
+    handleSegmentSync(udpIn, len, isSupp ? notifier2Udp.remoteIP() : notifierUdp.remoteIP());
+    return true;
   }
 
   //wled notifier, ignore if realtime packets active
   if (udpIn[0] == 0 && !realtimeMode && receiveNotifications)
   {
     //ignore notification if received within a second after sending a notification ourselves
-    if (millis() - notificationSentTime < 1000) return;
-    if (udpIn[1] > 199) return; //do not receive custom versions
+    if (millis() - notificationSentTime < 1000) return true;
+    if (udpIn[1] > 199) return true; //do not receive custom versions
+    IPAddress ip = isSupp ? notifier2Udp.remoteIP() : notifierUdp.remoteIP();
+    timeSyncSetReference(ip);
     
     bool someSel = (receiveNotificationBrightness || receiveNotificationColor || receiveNotificationEffects);
     //apply colors from notification
@@ -222,7 +487,7 @@ void handleNotifications()
           colSec[2] = udpIn[14];
           colSec[3] = udpIn[15];
         }
-        if (udpIn[11] > 5)
+        if (udpIn[11] > 5 && !timeSyncLocked(ip))
         {
           uint32_t t = (udpIn[25] << 24) | (udpIn[26] << 16) | (udpIn[27] << 8) | (udpIn[28]);
           t += 2;
@@ -255,10 +520,10 @@ void handleNotifications()
     
     if (receiveNotificationBrightness || !someSel) bri = udpIn[2];
     colorUpdated(NOTIFIER_CALL_MODE_NOTIFICATION);
-    return;
+    return true;
   }
 
-  if (!receiveDirect) return;
+  if (!receiveDirect) return true;
   
   //TPM2.NET
   if (udpIn[0] == 0x9c)
@@ -267,13 +532,13 @@ void handleNotifications()
     //if the number of LEDs in your installation doesn't allow that, please include padding bytes at the end of the last packet
     byte tpmType = udpIn[1];
     if (tpmType == 0xaa) { //TPM2.NET polling, expect answer
-      sendTPM2Ack(); return;
+      sendTPM2Ack(); return true;
     }
-    if (tpmType != 0xda) return; //return if notTPM2.NET data
+    if (tpmType != 0xda) return true; //return if notTPM2.NET data
 
     realtimeIP = (isSupp) ? notifier2Udp.remoteIP() : notifierUdp.remoteIP();
     realtimeLock(realtimeTimeoutMs, REALTIME_MODE_TPM2NET);
-    if (realtimeOverride) return;
+    if (realtimeOverride) return true;
 
     tpmPacketCount++; //increment the packet count
     if (tpmPacketCount == 1) tpmPayloadFrameSize = (udpIn[2] << 8) + udpIn[3]; //save frame size for the whole payload if this is the first packet
@@ -281,38 +546,37 @@ void handleNotifications()
     byte numPackets = udpIn[5];
 
     uint16_t id = (tpmPayloadFrameSize/3)*(packetNum-1); //start LED
-    for (uint16_t i = 6; i < tpmPayloadFrameSize + 4; i += 3)
-    {
-      if (id < ledCount)
-      {
-        setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], 0);
-        id++;
-      }
-      else break;
-    }
+    uint16_t dataLen = (packetSize > 6) ? packetSize - 6 : 0;
+    if (dataLen > tpmPayloadFrameSize) dataLen = tpmPayloadFrameSize;
+    setRealtimePixels(id, udpIn + 6, dataLen /3, 3);
+    rtStatPacket(REALTIME_MODE_TPM2NET, packetSize, rxStart);
     if (tpmPacketCount == numPackets) //reset packet count and show if all packets were received
     {
       tpmPacketCount = 0;
-      strip.show();
+      realtimeShow();
     }
-    return;
+    return true;
   }
 
-  //UDP realtime: 1 warls 2 drgb 3 drgbw
-  if (udpIn[0] > 0 && udpIn[0] < 5)
+  //UDP realtime: 1 warls 2 drgb 3 drgbw 4 dnrgb 5 dnrgbw 6 drle
+  if (udpIn[0] > 0 && udpIn[0] < 7)
   {
     realtimeIP = (isSupp) ? notifier2Udp.remoteIP() : notifierUdp.remoteIP();
     DEBUG_PRINTLN(realtimeIP);
-    if (packetSize < 2) return;
+    if (packetSize < 2) {
+      rtStats[REALTIME_MODE_UDP].badLen++;
+      return true;
+    }
+    if (realtimeMode != REALTIME_MODE_UDP || realtimeOverride) drleSynced = false; //pixels do not hold the sender's last frame
 
     if (udpIn[1] == 0)
     {
       realtimeTimeout = 0;
-      return;
+      return true;
     } else {
       realtimeLock(udpIn[1]*1000 +1, REALTIME_MODE_UDP);
     }
-    if (realtimeOverride) return;
+    if (realtimeOverride) return true;
 
     if (udpIn[0] == 1) //warls
     {
@@ -322,43 +586,30 @@ void handleNotifications()
       }
     } else if (udpIn[0] == 2) //drgb
     {
-      uint16_t id = 0;
-      for (uint16_t i = 2; i < packetSize -2; i += 3)
-      {
-        setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], 0);
-
-        id++; if (id >= ledCount) break;
-      }
+      setRealtimePixels(0, udpIn + 2, (packetSize -2) /3, 3);
     } else if (udpIn[0] == 3) //drgbw
     {
-      uint16_t id = 0;
-      for (uint16_t i = 2; i < packetSize -3; i += 4)
-      {
-        setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], udpIn[i+3]);
-        
-        id++; if (id >= ledCount) break;
-      }
+      setRealtimePixels(0, udpIn + 2, (packetSize -2) /4, 4);
     } else if (udpIn[0] == 4) //dnrgb
     {
+      if (packetSize < 4) { rtStats[REALTIME_MODE_UDP].badLen++; return true; }
       uint16_t id = ((udpIn[3] << 0) & 0xFF) + ((udpIn[2] << 8) & 0xFF00);
-      for (uint16_t i = 4; i < packetSize -2; i += 3)
-      {
-          if (id >= ledCount) break;
-        setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], 0);
-        id++;
-      }
+      setRealtimePixels(id, udpIn + 4, (packetSize -4) /3, 3);
     } else if (udpIn[0] == 5) //dnrgbw
     {
+      if (packetSize < 4) { rtStats[REALTIME_MODE_UDP].badLen++; return true; }
       uint16_t id = ((udpIn[3] << 0) & 0xFF) + ((udpIn[2] << 8) & 0xFF00);
-      for (uint16_t i = 4; i < packetSize -2; i += 4)
-      {
-          if (id >= ledCount) break;
-        setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], udpIn[i+3]);
-        id++;
-      }
+      setRealtimePixels(id, udpIn + 4, (packetSize -4) /4, 4);
+    } else if (udpIn[0] == 6) //drle
+    {
+      bool show = handleDrlePacket(udpIn, packetSize);
+      rtStatPacket(REALTIME_MODE_UDP, packetSize, rxStart);
+      if (show) realtimeShow();
+      return true;
     }
-    strip.show();
-    return;
+    rtStatPacket(REALTIME_MODE_UDP, packetSize, rxStart);
+    realtimeShow();
+    return true;
   }
 
   // API over UDP
@@ -374,13 +625,24 @@ void handleNotifications()
     JsonObject root = jsonBuffer.as<JsonObject>();
     if (!error && !root.isNull()) deserializeState(root);
   }
+  return true;
 }
 
 
+static byte* realtimeBufferIncoming(uint16_t &leds, byte &bpp);
+
 void setRealtimePixel(uint16_t i, byte r, byte g, byte b, byte w)
 {
   uint16_t pix = i + arlsOffset;
-  if (pix < ledCount)
+  uint16_t bufLeds; byte bufBpp;
+  byte* buf = (pix < ledCount) ? realtimeBufferIncoming(bufLeds, bufBpp) : nullptr;
+  if (buf)
+  {
+    if (pix >= bufLeds) return;
+    byte* dst = buf + pix * bufBpp;
+    dst[0] = r; dst[1] = g; dst[2] = b;
+    if (bufBpp > 3) dst[3] = w;
+  } else if (pix < ledCount)
   {
     if (!arlsDisableGammaCorrection && strip.gammaCorrectCol)
     {
@@ -391,6 +653,276 @@ void setRealtimePixel(uint16_t i, byte r, byte g, byte b, byte w)
   }
 }
 
+//bulk version of setRealtimePixel() for count consecutive pixels of R,G,B(,W) bytes, stride apart
+void setRealtimePixels(uint16_t i, const uint8_t* data, uint16_t count, uint8_t stride)
+{
+  int32_t pix = (int32_t)i + arlsOffset;
+  if (pix < 0) { //negative offset, the first pixels fall before the start of the strip
+    uint16_t skip = -pix;
+    if (skip >= count) return;
+    data += skip * stride;
+    count -= skip;
+    pix = 0;
+  }
+  if (pix >= ledCount || stride < 3) return;
+  if (pix + count > ledCount) count = ledCount - pix;
+  uint16_t bufLeds; byte bufBpp;
+  byte* buf = realtimeBufferIncoming(bufLeds, bufBpp);
+  if (buf) {
+    if (pix >= bufLeds) return;
+    if (pix + count > bufLeds) count = bufLeds - pix;
+    byte* dst = buf + pix * bufBpp;
+    if (stride == bufBpp) {
+      memcpy(dst, data, count * stride);
+      return;
+    }
+    for (uint16_t j = 0; j < count; j++, data += stride, dst += bufBpp) {
+      dst[0] = data[0]; dst[1] = data[1]; dst[2] = data[2];
+      if (bufBpp > 3) dst[3] = (stride > 3) ? data[3] : 0;
+    }
+    return;
+  }
+  strip.setRealtimePixels(pix, data, count, stride, !arlsDisableGammaCorrection && strip.gammaCorrectCol);
+}
+
+/*********************************************************************************************\
+   Compressed realtime protocol (DRLE, protocol byte 6), see tools/drle.js for an encoder
+   0: 6, 1: timeout in s, 2: flags, 3: sequence number (+1 per packet), 4-5: start LED, 6-: ops
+   each op byte holds the type in bits 7-6 and the number of LEDs - 1 (1-64) in bits 5-0:
+   0 unchanged since the previous frame, 1 literal (n pixels follow), 2 run (1 pixel follows, repeated n times)
+\*********************************************************************************************/
+//returns true if the frame is complete and should be shown
+bool handleDrlePacket(const uint8_t* udpIn, uint16_t packetSize)
+{
+  if (packetSize < DRLE_HEADER_LEN) { rtStats[REALTIME_MODE_UDP].badLen++; return false; }
+  byte flags = udpIn[2];
+  byte seq = udpIn[3];
+  bool inSequence = drleSynced && seq == (byte)(drleLastSeq +1);
+  drleLastSeq = seq;
+
+  //delta data only applies on top of the previous packet, after a loss wait for the next keyframe
+  if (!(flags & DRLE_FLAG_KEYFRAME) && !inSequence) {
+    drleSynced = false;
+    rtStats[REALTIME_MODE_UDP].seqDrops++;
+    return false;
+  }
+
+  uint8_t bpp = (flags & DRLE_FLAG_RGBW) ? 4 : 3;
+  uint16_t pix = (udpIn[4] << 8) | udpIn[5];
+  const uint8_t* in = udpIn + DRLE_HEADER_LEN;
+  uint16_t len = packetSize - DRLE_HEADER_LEN;
+  uint16_t i = 0;
+  byte run[64*4];
+  while (i < len) {
+    byte op = in[i] >> 6;
+    uint16_t n = (in[i] & 0x3F) +1;
+    i++;
+    if (op == 1) { //literal
+      if (i + n*bpp > len) break;
+      setRealtimePixels(pix, in + i, n, bpp);
+      i += n*bpp;
+    } else if (op == 2) { //run
+      if (i + bpp > len) break;
+      for (uint16_t j = 0; j < n; j++) memcpy(run + j*bpp, in + i, bpp);
+      setRealtimePixels(pix, run, n, bpp);
+      i += bpp;
+    } else if (op != 0) break;
+    pix += n;
+  }
+  if (i != len) { //truncated or unknown op, the frame is incomplete
+    drleSynced = false;
+    rtStats[REALTIME_MODE_UDP].badLen++;
+    return false;
+  }
+  drleSynced = true;
+  return flags & DRLE_FLAG_PUSH;
+}
+
+/*********************************************************************************************\
+   Realtime jitter buffer: complete frames are queued and shown at the rate they arrive on average
+\*********************************************************************************************/
+static bool realtimeBufferMode()
+{
+  if (!realtimeBufferDepth || realtimeOverride) return false;
+  switch (realtimeMode) {
+    case REALTIME_MODE_UDP:
+    case REALTIME_MODE_HYPERION:
+    case REALTIME_MODE_E131:
+    case REALTIME_MODE_ARTNET:
+    case REALTIME_MODE_TPM2NET:
+    case REALTIME_MODE_DDP: return true;
+  }
+  return false; //JSON live data and serial are shown directly
+}
+
+static inline byte* rtBufSlot(uint8_t slot)
+{
+  return rtBuf + (slot +1) * rtBufLeds * rtBufBpp; //slot -1 is the incoming frame
+}
+
+//true if incoming realtime data is written to the jitter buffer.
+//Network callbacks only write into an existing buffer, it is allocated and freed by handleRealtimeBuffer() in loop()
+bool realtimeBuffered()
+{
+  return rtBuf && realtimeBufferMode();
+}
+
+//the incoming frame of the jitter buffer if realtime data is written to it, nullptr otherwise.
+//The pointer and its size are read together, so a network callback keeps using them even if loop() frees the buffer meanwhile
+//(freeRealtimeBuffer() waits for E1.31/DDP callbacks, the other protocols are received in loop())
+static byte* realtimeBufferIncoming(uint16_t &leds, byte &bpp)
+{
+  if (!realtimeBufferMode()) return nullptr;
+  NET_LOCK();
+  byte* buf = rtBuf;
+  leds = rtBufLeds;
+  bpp = rtBufBpp;
+  NET_UNLOCK();
+  return buf;
+}
+
+static void allocRealtimeBuffer()
+{
+  byte bpp = strip.getPixelBytes();
+  uint32_t size = (realtimeBufferDepth +1) * ledCount * bpp;
+  //same heap budget as the busses, the buffer must not take what the segments and the next request need
+  if (size + strip.getBusMemReserve(false) > ESP.getFreeHeap()) {
+    DEBUG_PRINTLN(F("No heap for realtime buffer!"));
+    rtBufNoMem = true;
+    return;
+  }
+  byte* buf = (byte*)calloc(size, 1);
+  if (!buf) { rtBufNoMem = true; return; }
+  rtBufBpp = bpp;
+  rtBufLeds = ledCount;
+  rtBufSlots = realtimeBufferDepth;
+  rtBufHead = 0; rtBufCount = 0;
+  rtBufPlaying = false;
+  rtBufLastFrame = 0; rtBufInterval = 0;
+  NET_LOCK();
+  rtBuf = buf;
+  NET_UNLOCK();
+}
+
+void freeRealtimeBuffer()
+{
+  NET_LOCK();
+  byte* buf = rtBuf;
+  rtBuf = nullptr;
+  NET_UNLOCK();
+  while (e131UniverseUsers) delay(1); //an E1.31/DDP callback may still be writing into it
+  free(buf);
+  rtBufCount = 0;
+}
+
+//a realtime frame is complete
+void realtimeShow()
+{
+  if (!realtimeBuffered()) {
+    strip.show();
+    rtStatFrame(rtFrameRx);
+    rtFrameRx = 0;
+    return;
+  }
+  unsigned long now = micros();
+  if (rtBufLastFrame) {
+    uint32_t dt = now - rtBufLastFrame;
+    if (dt < 1000000) rtBufInterval = rtBufInterval ? (rtBufInterval*7 + dt) >> 3 : dt; //ignore pauses in the stream
+  }
+  rtBufLastFrame = now;
+
+  if (rtBufCount == rtBufSlots) { //sender is ahead, drop the stale frame
+    rtBufHead = (rtBufHead +1) % rtBufSlots;
+    rtBufCount--;
+    rtBufEarly++;
+  }
+  uint8_t tail = (rtBufHead + rtBufCount) % rtBufSlots;
+  memcpy(rtBufSlot(tail), rtBuf, rtBufLeds * rtBufBpp);
+  rtBufRx[tail] = rtFrameRx;
+  rtFrameRx = 0;
+  rtBufCount++;
+}
+
+//shows buffered frames at a steady cadence, call from loop()
+void handleRealtimeBuffer()
+{
+  if (!rtBuf) {
+    if (!realtimeBufferMode()) rtBufNoMem = false; //try again with the next stream
+    else if (!rtBufNoMem) allocRealtimeBuffer();
+    return;
+  }
+  if (!realtimeBufferMode() || rtBufSlots != realtimeBufferDepth || rtBufLeds != ledCount || rtBufBpp != strip.getPixelBytes()) {
+    freeRealtimeBuffer(); //stream ended or settings changed
+    return;
+  }
+
+  unsigned long now = micros();
+  if (!rtBufPlaying) {
+    if (rtBufCount < rtBufSlots) return; //wait until the buffer is filled
+    rtBufPlaying = true;
+    rtBufNext = now;
+  }
+  if ((long)(now - rtBufNext) < 0) return;
+  if (!rtBufCount) { //next frame is late, refill the buffer before continuing
+    rtBufLate++;
+    rtBufPlaying = false;
+    return;
+  }
+
+  strip.setRealtimePixels(0, rtBufSlot(rtBufHead), rtBufLeds, rtBufBpp, !arlsDisableGammaCorrection && strip.gammaCorrectCol);
+  strip.show();
+  rtStatFrame(rtBufRx[rtBufHead]);
+  rtBufHead = (rtBufHead +1) % rtBufSlots;
+  rtBufCount--;
+  rtBufFrames++;
+
+  rtBufNext += rtBufInterval;
+  if ((long)(now - rtBufNext) > (long)rtBufInterval) rtBufNext = now; //do not catch up in a burst after a stall
+}
+
+/*********************************************************************************************\
+   Realtime ingest statistics
+\*********************************************************************************************/
+//a realtime packet of the given protocol was decoded
+void rtStatPacket(byte mode, uint16_t len, unsigned long decodeStart)
+{
+  if (mode > REALTIME_MODE_DDP) return;
+  RealtimeStats &s = rtStats[mode];
+  uint32_t t = micros() - decodeStart;
+  s.decodeUs = s.packets ? (s.decodeUs*7 + t) >> 3 : t;
+  s.packets++;
+  s.bytes += len;
+  if (!rtFrameRx && realtimeMode) rtFrameRx = decodeStart | 1; //0 means no frame pending
+}
+
+//a realtime frame was shown, rxTime is when its first packet arrived
+void rtStatFrame(unsigned long rxTime)
+{
+  if (realtimeMode > REALTIME_MODE_DDP) return;
+  RealtimeStats &s = rtStats[realtimeMode];
+  if (rxTime) {
+    uint32_t t = micros() - rxTime;
+    s.latencyUs = s.frames ? (s.latencyUs*7 + t) >> 3 : t;
+  }
+  s.frames++;
+}
+
+//per second rates
+void handleRealtimeStats()
+{
+  unsigned long now = millis();
+  if (now - rtStatsTime < 1000) return;
+  uint32_t dt = now - rtStatsTime;
+  rtStatsTime = now;
+  for (byte m = 0; m <= REALTIME_MODE_DDP; m++) {
+    RealtimeStats &s = rtStats[m];
+    s.pps = (s.packets - s.lastPackets) * 1000 / dt;
+    s.bps = (uint64_t)(s.bytes - s.lastBytes) * 1000 / dt;
+    s.fps = (s.frames - s.lastFrames) * 1000 / dt;
+    s.lastPackets = s.packets; s.lastBytes = s.bytes; s.lastFrames = s.frames;
+  }
+}
+
 /*********************************************************************************************\
    Refresh aging for remote units, drop if too old...
 \*********************************************************************************************/
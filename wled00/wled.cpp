@@ -227,7 +227,10 @@ void WLED::loop()
     else if (!noWifiSleep)
       delay(1); //required to make sure ESP enters modem sleep (see #1184)
 #endif
+  } else {
+    strip.cancelFrame(); //a frame rendered before realtime mode started must not be shown after it
   }
+  busses.probeTiming();
   yield();
 #ifdef ESP8266
   MDNS.update();
@@ -241,24 +244,35 @@ void WLED::loop()
   }
 
   //LED settings have been saved, re-init busses
-  //This code block causes severe FPS drop on ESP32 with the original "if (busConfigs[0] != nullptr)" conditional. Investigate! 
+  //only busses whose type, pins or length changed are re-created, the others keep running (and the LED map is kept)
   if (doInitBusses) {
     doInitBusses = false;
-    busses.removeAll();
-    uint32_t mem = 0;
+    unsigned long reconfigStart = micros();
     strip.isRgbw = false;
     for (uint8_t i = 0; i < WLED_MAX_BUSSES; i++) {
       if (busConfigs[i] == nullptr) break;
-      mem += busses.memUsage(*busConfigs[i]);
-      if (mem <= MAX_LED_MEMORY) busses.add(*busConfigs[i]);
-      //if (BusManager::isRgbw(busConfigs[i]->type)) strip.isRgbw = true;
       strip.isRgbw = (strip.isRgbw || BusManager::isRgbw(busConfigs[i]->type));
+    }
+    busses.resetAdmission(strip.getBusMemReserve(false));
+    uint8_t rebuilt = busses.reconfigure(busConfigs);
+    for (uint8_t i = 0; i < WLED_MAX_BUSSES; i++) {
+      if (busConfigs[i] == nullptr) break;
       delete busConfigs[i]; busConfigs[i] = nullptr;
     }
-    strip.finalizeInit(ledCount, skipFirstLed);
+    strip.finalizeInit(ledCount, skipFirstLed, false);
+    busReconfigTime = micros() - reconfigStart;
+    DEBUG_PRINT(F("Busses reconfigured, re-created: ")); DEBUG_PRINT(rebuilt);
+    DEBUG_PRINT(F(", rejected: ")); DEBUG_PRINT(busses.getNumRejected());
+    DEBUG_PRINT(F(", took us: ")); DEBUG_PRINTLN(busReconfigTime);
     yield();
     serializeConfig();
   }
+
+  //LED count or DMX settings have been saved, the universe state is shared with the E1.31 callback
+  if (doInitE131) {
+    doInitE131 = false;
+    initE131Universes();
+  }
   
   yield();
   handleWs();
@@ -453,7 +467,8 @@ void WLED::initAP(bool resetAP)
     if (udpPort2 > 0 && udpPort2 != ntpLocalPort && udpPort2 != udpPort && udpPort2 != udpRgbPort) {
       udp2Connected = notifier2Udp.begin(udpPort2);
     }
-    e131.begin(false, e131Port, e131Universe, E131_MAX_UNIVERSE_COUNT);
+    initE131Universes();
+    e131.begin(false, e131Port, e131Universe, e131NumUniverses);
 
     dnsServer.setErrorReplyCode(DNSReplyCode::NoError);
     dnsServer.start(53, "*", WiFi.softAPIP());
@@ -580,7 +595,8 @@ void WLED::initInterfaces()
     ntpConnected = ntpUdp.begin(ntpLocalPort);
 
   initBlynk(blynkApiKey, blynkHost, blynkPort);
-  e131.begin(e131Multicast, e131Port, e131Universe, E131_MAX_UNIVERSE_COUNT);
+  initE131Universes();
+  e131.begin(e131Multicast, e131Port, e131Universe, e131NumUniverses);
   reconnectHue();
   initMqtt();
   interfacesInited = true;
@@ -124,6 +124,8 @@
 #include "NodeStruct.h"
 #include "pin_manager.h"
 #include "bus_manager.h"
+#include "timesync.h"
+#include "ddp_hold.h"
 
 #ifndef CLIENT_SSID
   #define CLIENT_SSID DEFAULT_CLIENT_SSID
@@ -171,6 +173,18 @@
 # define _INIT_N(x) UNPACK x
 #endif
 
+// state shared between loop() and the network callbacks, which run in their own task on ESP32.
+// Hold the lock only briefly and never allocate, free or block while holding it.
+// On ESP8266 the callbacks run between loop() passes, so no lock is needed
+#ifdef ARDUINO_ARCH_ESP32
+WLED_GLOBAL portMUX_TYPE netMux _INIT(portMUX_INITIALIZER_UNLOCKED);
+#define NET_LOCK()   portENTER_CRITICAL(&netMux)
+#define NET_UNLOCK() portEXIT_CRITICAL(&netMux)
+#else
+#define NET_LOCK()
+#define NET_UNLOCK()
+#endif
+
 // Global Variable definitions
 WLED_GLOBAL char versionString[] _INIT("0.12.0");
 #define WLED_CODENAME "Hikari"
@@ -270,6 +284,8 @@ WLED_GLOBAL bool notifyAlexa  _INIT(false);                       // send notifi
 WLED_GLOBAL bool notifyMacro  _INIT(false);                       // send notification for macro
 WLED_GLOBAL bool notifyHue    _INIT(true);                        // send notification if Hue light changes
 WLED_GLOBAL bool notifyTwice  _INIT(false);                       // notifications use UDP: enable if devices don't sync reliably
+WLED_GLOBAL bool notifySegments _INIT(false);                     // send segment sync packets (v2) instead of the main segment only notifier packet
+WLED_GLOBAL bool timeSyncEnabled _INIT(false);                    // synchronize the effect clock with the node sending notifications
 
 WLED_GLOBAL bool alexaEnabled _INIT(false);                       // enable device discovery by Amazon Echo
 WLED_GLOBAL char alexaInvocationName[33] _INIT("Light");          // speech control name of device. Choose something voice-to-text can understand
@@ -282,6 +298,9 @@ WLED_GLOBAL uint16_t realtimeTimeoutMs _INIT(2500);               // ms timeout
 WLED_GLOBAL int arlsOffset _INIT(0);                              // realtime LED offset
 WLED_GLOBAL bool receiveDirect _INIT(true);                       // receive UDP realtime
 WLED_GLOBAL bool arlsDisableGammaCorrection _INIT(true);          // activate if gamma correction is handled by the source
+WLED_GLOBAL uint16_t serialBaud _INIT(1152);                      // Adalight/TPM2 serial baud rate / 100
+WLED_GLOBAL uint32_t serialErrors _INIT(0);                       // serial frames with bad header checksum or end byte
+WLED_GLOBAL byte realtimeBufferDepth _INIT(0);                    // realtime frames held back to show them at a steady rate (0 = off)
 WLED_GLOBAL bool arlsForceMaxBri _INIT(false);                    // enable to force max brightness if source has very dark colors that would be black
 
 #ifdef WLED_ENABLE_DMX
@@ -293,7 +312,29 @@ WLED_GLOBAL uint16_t e131Port _INIT(5568);                        // DMX in port
 WLED_GLOBAL byte DMXMode _INIT(DMX_MODE_MULTIPLE_RGB);            // DMX mode (s.a.)
 WLED_GLOBAL uint16_t DMXAddress _INIT(1);                         // DMX start address of fixture, a.k.a. first Channel [for E1.31 (sACN) protocol]
 WLED_GLOBAL byte DMXOldDimmer _INIT(0);                           // only update brightness on change
-WLED_GLOBAL byte e131LastSequenceNumber[E131_MAX_UNIVERSE_COUNT]; // to detect packet loss
+WLED_GLOBAL E131Universe* e131Universes _INIT(nullptr);           // state of each universe, sized by initE131Universes()
+WLED_GLOBAL uint8_t e131NumUniverses _INIT(0);
+WLED_GLOBAL volatile uint8_t e131UniverseUsers _INIT(0);          // network callbacks using e131Universes, see e131AcquireUniverses()
+WLED_GLOBAL bool doInitE131 _INIT(false);                         // re-init the universe state in loop()
+WLED_GLOBAL byte ddpLastSequenceNumber _INIT(0);                  // to detect late DDP packets
+WLED_GLOBAL byte ddpFrameSpan _INIT(0);                           // sequence numbers used by the DDP frame in progress
+WLED_GLOBAL byte ddpPrevFrameSpan _INIT(0);                       // sequence numbers used by the last pushed DDP frame
+WLED_GLOBAL DdpFrameHold ddpHold;                                 // DDP frame with timecode waiting in the pixel buffer
+WLED_GLOBAL bool ddpHoldNoMem _INIT(false);                       // not enough heap for that copy during this stream
+WLED_GLOBAL unsigned long ddpLastTimecode _INIT(0);               // last DDP packet with timecode
+WLED_GLOBAL uint32_t ddpTimecodeOffset _INIT(0);                  // sender clock - local clock + min. network delay, in ms
+WLED_GLOBAL byte ddpReplyPending _INIT(0);                        // DDP_ID_STATUS or DDP_ID_CONFIG query to answer
+WLED_GLOBAL IPAddress ddpReplyIP;
+WLED_GLOBAL uint16_t ddpReplyPort _INIT(DDP_DEFAULT_PORT);         // source port of the query
+WLED_GLOBAL TimeSync timeSync;                                    // effect clock sync with the last notification sender
+WLED_GLOBAL unsigned long e131FrameStart _INIT(0);                // first packet of the frame being assembled (0 = none)
+WLED_GLOBAL uint32_t e131Frames _INIT(0);                         // frames assembled
+WLED_GLOBAL uint32_t e131FramesIncomplete _INIT(0);               // frames assembled with universes missing
+WLED_GLOBAL uint32_t e131FramesSkipped _INIT(0);                  // frames overwritten by the next one before loop() could show them
+WLED_GLOBAL uint8_t e131FramesReady _INIT(0);                     // frames assembled since the last show
+WLED_GLOBAL unsigned long e131LastSync _INIT(0);                  // last E1.31 sync or ArtSync packet
+WLED_GLOBAL uint16_t e131SyncAddress _INIT(0);                    // E1.31 synchronization universe announced by the sender
+WLED_GLOBAL bool e131WaitForSync _INIT(false);                    // show frames on sync packets instead of when complete
 WLED_GLOBAL bool e131Multicast _INIT(false);                      // multicast or unicast
 WLED_GLOBAL bool e131SkipOutOfSequence _INIT(false);              // freeze instead of flickering
 
@@ -478,11 +519,47 @@ WLED_GLOBAL IPAddress realtimeIP _INIT_N(((0, 0, 0, 0)));;
 WLED_GLOBAL unsigned long realtimeTimeout _INIT(0);
 WLED_GLOBAL uint8_t tpmPacketCount _INIT(0);
 WLED_GLOBAL uint16_t tpmPayloadFrameSize _INIT(0);
+WLED_GLOBAL byte drleLastSeq _INIT(0);           // sequence number of the last compressed realtime packet
+WLED_GLOBAL bool drleSynced _INIT(false);        // pixels hold the sender's previous frame, delta packets can be applied
+
+// realtime jitter buffer
+WLED_GLOBAL byte* rtBuf _INIT(nullptr);          // incoming frame followed by rtBufSlots complete frames
+WLED_GLOBAL uint16_t rtBufLeds _INIT(0);
+WLED_GLOBAL byte rtBufBpp _INIT(0);
+WLED_GLOBAL byte rtBufSlots _INIT(0);
+WLED_GLOBAL byte rtBufHead _INIT(0);             // oldest queued frame
+WLED_GLOBAL byte rtBufCount _INIT(0);            // queued frames
+WLED_GLOBAL bool rtBufPlaying _INIT(false);      // false while (re)filling the buffer
+WLED_GLOBAL unsigned long rtBufNext _INIT(0);    // micros() the next frame is due
+WLED_GLOBAL unsigned long rtBufLastFrame _INIT(0);
+WLED_GLOBAL uint32_t rtBufInterval _INIT(0);     // average us between incoming frames
+WLED_GLOBAL uint32_t rtBufFrames _INIT(0);       // frames shown from the buffer
+WLED_GLOBAL uint32_t rtBufLate _INIT(0);         // frames not received by the time they were due (buffer ran empty)
+WLED_GLOBAL bool rtBufNoMem _INIT(false);       // not enough heap for the buffer during this stream
+WLED_GLOBAL uint32_t rtBufEarly _INIT(0);        // frames received into a full buffer, the oldest one was dropped
+WLED_GLOBAL unsigned long rtBufRx[REALTIME_BUFFER_MAX]; // receive time of the queued frames
+
+// realtime ingest statistics
+WLED_GLOBAL RealtimeStats rtStats[REALTIME_MODE_DDP +1];
+WLED_GLOBAL unsigned long rtFrameRx _INIT(0);    // micros() the first packet of the frame being received arrived (0 = none)
+WLED_GLOBAL unsigned long rtStatsTime _INIT(0);  // last per second update
+
+// UDP receive queue stats
+WLED_GLOBAL uint32_t udpRxPackets _INIT(0);  // packets handled
+WLED_GLOBAL uint32_t udpRxRejected _INIT(0); // packets the handler discarded unread (too large or receiving disabled), not socket queue overflows
+WLED_GLOBAL uint32_t udpRxDeferred _INIT(0); // loops that stopped draining before the sockets were empty
+WLED_GLOBAL uint8_t udpRxDepth _INIT(0);     // packets handled in the last loop
+WLED_GLOBAL uint8_t udpRxMaxDepth _INIT(0);
+
+// /json streaming stats
+WLED_GLOBAL uint32_t jsonStreamMinHeap _INIT(UINT32_MAX); // lowest free heap while a section was serialized
+WLED_GLOBAL uint16_t jsonStreamFails _INIT(0);            // responses ended early, out of memory or section too large
 
 // mqtt
 WLED_GLOBAL unsigned long lastMqttReconnectAttempt _INIT(0);
 WLED_GLOBAL unsigned long lastInterfaceUpdate _INIT(0);
 WLED_GLOBAL byte interfaceUpdateCallMode _INIT(NOTIFIER_CALL_MODE_INIT);
+WLED_GLOBAL uint32_t stateVersion _INIT(1);            // bumped on every state change, invalidates the serialized state
 WLED_GLOBAL char mqttStatusTopic[40] _INIT("");        // this must be global because of async handlers
 
 // alexa udp
@@ -526,12 +603,14 @@ WLED_GLOBAL byte optionType;
 
 WLED_GLOBAL bool doReboot _INIT(false);        // flag to initiate reboot from async handlers
 WLED_GLOBAL bool doPublishMqtt _INIT(false);
+WLED_GLOBAL uint32_t mqttPublishedEtag _INIT(0);  // state snapshot last published, to skip repeated publishes
 
 // server library objects
 WLED_GLOBAL AsyncWebServer server _INIT_N(((80)));
 #ifdef WLED_ENABLE_WEBSOCKETS
 WLED_GLOBAL AsyncWebSocket ws _INIT_N((("/ws")));
 #endif
+WLED_GLOBAL uint16_t wsMaxMessage _INIT(WS_MAX_MESSAGE);     // max. size of websocket messages reassembled from several frames
 WLED_GLOBAL AsyncClient* hueClient _INIT(NULL);
 WLED_GLOBAL AsyncMqttClient* mqtt _INIT(NULL);
 
@@ -546,6 +625,7 @@ WLED_GLOBAL BusManager busses _INIT(BusManager());
 WLED_GLOBAL WS2812FX strip _INIT(WS2812FX());
 WLED_GLOBAL BusConfig* busConfigs[WLED_MAX_BUSSES] _INIT({nullptr}); //temporary, to remember values from network callback until after 
 WLED_GLOBAL bool doInitBusses _INIT(false);
+WLED_GLOBAL uint32_t busReconfigTime _INIT(0); // duration of the last LED settings reconfiguration in us
 
 // Usermod manager
 WLED_GLOBAL UsermodManager usermods _INIT(UsermodManager());
@@ -4,6 +4,9 @@
  * Adalight and TPM2 handler
  */
 
+//bytes read from the serial buffer at once
+#define SERIAL_READ_CHUNK 128
+
 enum class AdaState {
   Header_A,
   Header_d,
@@ -11,92 +14,139 @@ enum class AdaState {
   Header_CountHi,
   Header_CountLo,
   Header_CountCheck,
-  Data_Red,
-  Data_Green,
-  Data_Blue,
+  Data,
   TPM2_Header_Type,
   TPM2_Header_CountHi,
-  TPM2_Header_CountLo
+  TPM2_Header_CountLo,
+  TPM2_End
 };
 
+#ifdef WLED_ENABLE_ADALIGHT
+static byte* serialFrame = nullptr;
+static uint16_t serialFrameSize = 0; //bytes allocated, 3 per LED
+
+//makes sure the frame buffer holds all LEDs, false if out of memory
+static bool allocSerialFrame()
+{
+  uint16_t size = ledCount * 3;
+  if (serialFrame && serialFrameSize == size) return true;
+  free(serialFrame);
+  serialFrame = (byte*)malloc(size);
+  serialFrameSize = serialFrame ? size : 0;
+  return serialFrame;
+}
+
+//shows a complete frame of len RGB bytes, the first one received at rxStart (micros())
+static void showSerialFrame(uint32_t len, unsigned long rxStart)
+{
+  if (!realtimeMode && bri == 0) strip.setBrightness(briLast);
+  realtimeLock(realtimeTimeoutMs, REALTIME_MODE_ADALIGHT);
+  if (realtimeOverride) return;
+
+  unsigned long decodeStart = micros();
+  if (len > serialFrameSize) len = serialFrameSize;
+  setRealtimePixels(0, serialFrame, len /3, 3);
+  if (!rtFrameRx) rtFrameRx = rxStart | 1;
+  rtStatPacket(REALTIME_MODE_ADALIGHT, len, decodeStart);
+  realtimeShow();
+}
+#endif
+
 void handleSerial()
 {
   #ifdef WLED_ENABLE_ADALIGHT
   static auto state = AdaState::Header_A;
-  static uint16_t count = 0;
-  static uint16_t pixel = 0;
+  static uint32_t count = 0;    //data bytes of the frame
+  static uint32_t received = 0;
   static byte check = 0x00;
-  static byte red   = 0x00;
-  static byte green = 0x00;
-  
-  while (Serial.available() > 0)
+  static bool tpm2 = false;
+  static unsigned long rxStart = 0;
+
+  //only handle what is available now, so a fast sender can not keep the loop here
+  int avail = Serial.available();
+  byte buf[SERIAL_READ_CHUNK];
+  while (avail > 0)
   {
-    yield();
-    byte next = Serial.read();
-    switch (state) {
-      case AdaState::Header_A:
-        if (next == 'A') state = AdaState::Header_d;
-        else if (next == 0xC9) { //TPM2 start byte
-          state = AdaState::TPM2_Header_Type;
-        }
-        break;
-      case AdaState::Header_d:
-        if (next == 'd') state = AdaState::Header_a;
-        else             state = AdaState::Header_A;
-        break;
-      case AdaState::Header_a:
-        if (next == 'a') state = AdaState::Header_CountHi;
-        else             state = AdaState::Header_A;
-        break;
-      case AdaState::Header_CountHi:
-        pixel = 0;
-        count = next * 0x100;
-        check = next;
-        state = AdaState::Header_CountLo;
-        break;
-      case AdaState::Header_CountLo:
-        count += next + 1;
-        check = check ^ next ^ 0x55;
-        state = AdaState::Header_CountCheck;
-        break;
-      case AdaState::Header_CountCheck:
-        if (check == next) state = AdaState::Data_Red;
-        else               state = AdaState::Header_A;
-        break;
-      case AdaState::TPM2_Header_Type:
-        state = AdaState::Header_A; //(unsupported) TPM2 command or invalid type
-        if (next == 0xDA) state = AdaState::TPM2_Header_CountHi; //TPM2 data
-        else if (next == 0xAA) Serial.write(0xAC); //TPM2 ping
-        break;
-      case AdaState::TPM2_Header_CountHi:
-        pixel = 0;
-        count = (next * 0x100) /3;
-        state = AdaState::TPM2_Header_CountLo;
-        break;
-      case AdaState::TPM2_Header_CountLo:
-        count += next /3;
-        state = AdaState::Data_Red;
-        break;
-      case AdaState::Data_Red:
-        red   = next;
-        state = AdaState::Data_Green;
-        break;
-      case AdaState::Data_Green:
-        green = next;
-        state = AdaState::Data_Blue;
-        break;
-      case AdaState::Data_Blue:
-        byte blue  = next;
-        if (!realtimeOverride) setRealtimePixel(pixel++, red, green, blue, 0);
-        if (--count > 0) state = AdaState::Data_Red;
-        else {
-          if (!realtimeMode && bri == 0) strip.setBrightness(briLast);
-          realtimeLock(realtimeTimeoutMs, REALTIME_MODE_ADALIGHT);
+    uint16_t len = Serial.readBytes(buf, (avail < SERIAL_READ_CHUNK) ? avail : SERIAL_READ_CHUNK);
+    if (!len) break;
+    avail -= len;
 
-          if (!realtimeOverride) strip.show();
-          state = AdaState::Header_A;
+    for (uint16_t i = 0; i < len; i++) {
+      byte next = buf[i];
+      switch (state) {
+        case AdaState::Header_A:
+          if (next == 'A') state = AdaState::Header_d;
+          else if (next == 0xC9) { //TPM2 start byte
+            state = AdaState::TPM2_Header_Type;
+          } else break;
+          rxStart = micros();
+          break;
+        case AdaState::Header_d:
+          if (next == 'd') state = AdaState::Header_a;
+          else             state = AdaState::Header_A;
+          break;
+        case AdaState::Header_a:
+          if (next == 'a') state = AdaState::Header_CountHi;
+          else             state = AdaState::Header_A;
+          break;
+        case AdaState::Header_CountHi:
+          count = next << 8;
+          check = next;
+          state = AdaState::Header_CountLo;
+          break;
+        case AdaState::Header_CountLo:
+          count = ((count | next) +1) *3; //LED count - 1
+          check = check ^ next ^ 0x55;
+          state = AdaState::Header_CountCheck;
+          break;
+        case AdaState::Header_CountCheck:
+          if (check == next) {
+            tpm2 = false;
+            received = 0;
+            state = allocSerialFrame() ? AdaState::Data : AdaState::Header_A;
+          } else {
+            serialErrors++;
+            state = AdaState::Header_A;
+          }
+          break;
+        case AdaState::TPM2_Header_Type:
+          state = AdaState::Header_A; //(unsupported) TPM2 command or invalid type
+          if (next == 0xDA) state = AdaState::TPM2_Header_CountHi; //TPM2 data
+          else if (next == 0xAA) Serial.write(0xAC); //TPM2 ping
+          break;
+        case AdaState::TPM2_Header_CountHi:
+          count = next << 8;
+          state = AdaState::TPM2_Header_CountLo;
+          break;
+        case AdaState::TPM2_Header_CountLo:
+          count |= next; //data bytes
+          tpm2 = true;
+          received = 0;
+          if (!allocSerialFrame()) state = AdaState::Header_A;
+          else state = count ? AdaState::Data : AdaState::TPM2_End;
+          break;
+        case AdaState::Data: {
+          //copy as much of the frame as this chunk holds at once, bytes for LEDs we don't have are skipped
+          uint32_t n = len - i;
+          if (n > count - received) n = count - received;
+          if (received < serialFrameSize) memcpy(serialFrame + received, buf + i, (serialFrameSize - received < n) ? serialFrameSize - received : n);
+          received += n;
+          i += n -1;
+          if (received < count) break;
+          if (tpm2) {
+            state = AdaState::TPM2_End;
+          } else {
+            showSerialFrame(count, rxStart);
+            state = AdaState::Header_A;
+          }
+          break;
         }
-        break;
+        case AdaState::TPM2_End:
+          if (next == 0x36) showSerialFrame(count, rxStart);
+          else serialErrors++;
+          state = AdaState::Header_A;
+          break;
+      }
     }
   }
   #endif
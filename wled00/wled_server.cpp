@@ -32,6 +32,42 @@ bool captivePortal(AsyncWebServerRequest *request)
   return false;
 }
 
+//state of a binary pixel update applied while its body arrives
+struct PixelUpload {
+  uint8_t head[PIXEL_SET_HEADER_LEN];
+  uint8_t headLen;
+  uint8_t part[4];  //pixel split between two body chunks
+  uint8_t partLen;
+  uint16_t pos;
+};
+
+void handlePixelUploadBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+{
+  if (total > PIXEL_SET_MAX_LEN) return;
+  if (!index) request->_tempObject = calloc(1, sizeof(PixelUpload)); //freed with the request
+  PixelUpload* u = (PixelUpload*)request->_tempObject;
+  if (!u) return;
+
+  while (len && u->headLen < PIXEL_SET_HEADER_LEN) {
+    u->head[u->headLen++] = *data++; len--;
+    if (u->headLen == PIXEL_SET_HEADER_LEN) u->pos = (u->head[2] << 8) | u->head[3];
+  }
+  if (!len) return;
+  uint8_t bpp = (u->head[1] & PIXEL_SET_RGBW) ? 4 : 3;
+
+  if (u->partLen) {
+    while (len && u->partLen < bpp) { u->part[u->partLen++] = *data++; len--; }
+    if (u->partLen < bpp) return;
+    setSegmentPixels(u->head[0], u->pos++, u->part, 1, bpp);
+    u->partLen = 0;
+  }
+  uint16_t count = len / bpp;
+  setSegmentPixels(u->head[0], u->pos, data, count, bpp);
+  u->pos += count;
+  data += count * bpp; len -= count * bpp;
+  while (len) { u->part[u->partLen++] = *data++; len--; }
+}
+
 void initServer()
 {
   //CORS compatiblity
@@ -102,6 +138,18 @@ void initServer()
   });
   server.addHandler(handler);
 
+  //binary segment pixel update, applied as the body arrives (format see PIXEL_SET_HEADER_LEN)
+  server.on("/pixels", HTTP_POST, [](AsyncWebServerRequest *request){
+    PixelUpload* u = (PixelUpload*)request->_tempObject;
+    if (request->contentLength() > PIXEL_SET_MAX_LEN) {
+      request->send(413, "application/json", F("{\"error\":9}")); return;
+    }
+    if (!u || u->headLen < PIXEL_SET_HEADER_LEN) {
+      request->send(400, "application/json", F("{\"error\":9}")); return;
+    }
+    request->send(200, "application/json", F("{\"success\":true}"));
+  }, nullptr, handlePixelUploadBody);
+
   server.on("/version", HTTP_GET, [](AsyncWebServerRequest *request){
     request->send(200, "text/plain", (String)VERSION);
     });
@@ -7,58 +7,169 @@
 
 uint16_t wsLiveClientId = 0;
 unsigned long wsLastLiveTime = 0;
+uint16_t wsLiveInterval = 40;   //grows while the client does not keep up
+bool wsLiveBinary = false;      //client asked for the binary live view with {"lv":true,"lvb":max. LEDs}
+uint16_t wsLiveMaxLeds = 0;
+uint16_t wsLiveFrame = 0;
+uint32_t wsLiveLastShow = 0;
+uint16_t wsRtClientId = 0; //client receiving realtime ingest stats
+unsigned long wsLastRtTime = 0;
 //uint8_t* wsFrameBuffer = nullptr;
 
 #define WS_LIVE_INTERVAL 40
+#define WS_LIVE_MAX_INTERVAL 1000
+#define WS_LIVE_HEADER_LEN 10
+#ifdef ESP8266
+  #define WS_LIVE_CHUNK_LEDS 240
+  #define WS_LIVE_MAX_CHUNKS 4
+#else
+  #define WS_LIVE_CHUNK_LEDS 480
+  #define WS_LIVE_MAX_CHUNKS 8
+#endif
+#define WS_RT_INTERVAL 1000
+#define WS_RT_PROTOCOLS (REALTIME_MODE_DDP - REALTIME_MODE_UDP +1)
+//{"rt":{<protocol>:{9 counters}}}, the keys are flash strings and get copied (64 bytes per protocol)
+#define WS_RT_JSON_SIZE (JSON_OBJECT_SIZE(1) + JSON_OBJECT_SIZE(WS_RT_PROTOCOLS) + WS_RT_PROTOCOLS * (JSON_OBJECT_SIZE(9) + 64))
+#define WS_MAX_CLIENTS (DEFAULT_MAX_WS_CLIENTS +2) //cleanupClients() closes surplus clients with a delay
+
+//connected clients, those that sent {"v":2} receive only the changes to the state.
+//The web server task only sets id, msg and the requests under NET_LOCK, loop() owns the rest (handleWsRequests())
+struct WsClient {
+  uint32_t id = 0;
+  bool restart = false;                //request: {"v":2}, send the full state and deltas from then on
+  bool send = false;                   //request: send the state to this client
+  uint32_t ack = 0;                    //request: etag of the state the client acknowledged
+  bool delta = false;                  //also keeps the slot from being reused until loop() released the states
+  std::shared_ptr<StateSnapshot> base; //last acknowledged state, deltas are relative to it
+  std::shared_ptr<StateSnapshot> sent; //state of the last message sent
+  uint32_t deltas = 0;
+  uint32_t bytes = 0;                  //sent in deltas
+  uint32_t saved = 0;                  //compared to full state and info messages
+  uint8_t* msg = nullptr;              //message split into several frames or packets being reassembled
+  size_t msgLen = 0;                   //bytes of completed frames
+  bool msgDrop = false;                //message exceeds wsMaxMessage, skip its remaining frames
+};
+WsClient wsClients[WS_MAX_CLIENTS];
+size_t wsFullLen = 0; //length of the last full message, 0 until one was built
+bool wsSendAll = false; //request for a client without a slot, everyone gets the full state
+
+static WsClient* getWsClient(uint32_t id)
+{
+  for (byte i = 0; i < WS_MAX_CLIENTS; i++) if (wsClients[i].id == id) return &wsClients[i];
+  return nullptr;
+}
+
+static void freeWsMessage(WsClient* c)
+{
+  free(c->msg);
+  c->msg = nullptr;
+  c->msgLen = 0;
+  c->msgDrop = false;
+}
+
+//asks loop() to send the state to a client, called by the web server task
+static void requestWsSend(uint32_t id)
+{
+  NET_LOCK();
+  WsClient* c = getWsClient(id);
+  if (c) c->send = true;
+  else   wsSendAll = true;
+  NET_UNLOCK();
+}
+
+//a complete JSON message from a client
+static void handleWsMessage(AsyncWebSocketClient * client, uint8_t *data, size_t len)
+{
+  bool verboseResponse = false;
+  { //scope JsonDocument so it releases its buffer
+    DynamicJsonDocument jsonBuffer(JSON_BUFFER_SIZE);
+    DeserializationError error = deserializeJson(jsonBuffer, data, len);
+    JsonObject root = jsonBuffer.as<JsonObject>();
+    if (error || root.isNull()) return;
+
+    if (root.containsKey("lv"))
+    {
+      wsLiveClientId = root["lv"] ? client->id() : 0;
+      wsLiveBinary = root.containsKey(F("lvb"));
+      wsLiveMaxLeds = root[F("lvb")] | 0;
+      wsLiveInterval = WS_LIVE_INTERVAL;
+      wsLiveLastShow = 0;
+    }
+    if (root.containsKey("rt"))
+    {
+      wsRtClientId = root["rt"] ? client->id() : 0;
+    }
+
+    const char* ack = root[F("ack")];
+    NET_LOCK();
+    WsClient* c = getWsClient(client->id());
+    if (c && (root["v"] | 0) == 2) c->restart = true; //opt in to delta updates, they are relative to the full state sent in reply
+    if (c && ack) c->ack = strtoul(ack, nullptr, 16);
+    NET_UNLOCK();
+    if (root.size() == 1 && ack) return; //no state change
+    if (root.size() == 1 && (root["v"] | 0) == 2) verboseResponse = true;
+    else verboseResponse = deserializeState(root);
+  }
+  if (verboseResponse || millis() - lastInterfaceUpdate < 1900) requestWsSend(client->id()); //update if it takes longer than 100ms until next "broadcast"
+}
 
 void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len)
 {
   if(type == WS_EVT_CONNECT){
     //client connected
-    sendDataWs(client);
+    WsClient* c = nullptr;
+    NET_LOCK();
+    for (byte i = 0; i < WS_MAX_CLIENTS && !c; i++) if (!wsClients[i].id && !wsClients[i].delta) c = &wsClients[i];
+    if (c) { c->id = client->id(); c->send = true; }
+    else   wsSendAll = true;
+    NET_UNLOCK();
     //client->ping();
   } else if(type == WS_EVT_DISCONNECT){
     //client disconnected
     if (client->id() == wsLiveClientId) wsLiveClientId = 0;
+    if (client->id() == wsRtClientId) wsRtClientId = 0;
+    WsClient* c = getWsClient(client->id());
+    if (c) {
+      freeWsMessage(c);
+      NET_LOCK();
+      c->id = 0; //loop() releases its states
+      NET_UNLOCK();
+    }
   } else if(type == WS_EVT_DATA){
     //data packet
     AwsFrameInfo * info = (AwsFrameInfo*)arg;
-    if(info->final && info->index == 0 && info->len == len){
+    if(info->final && info->num == 0 && info->index == 0 && info->len == len){
       //the whole message is in a single frame and we got all of it's data (max. 1450byte)
       if(info->opcode == WS_TEXT)
       {
-        bool verboseResponse = false;
-        { //scope JsonDocument so it releases its buffer
-          DynamicJsonDocument jsonBuffer(JSON_BUFFER_SIZE);
-          DeserializationError error = deserializeJson(jsonBuffer, data, len);
-          JsonObject root = jsonBuffer.as<JsonObject>();
-          if (error || root.isNull()) return;
-
-          if (root.containsKey("lv"))
-          {
-            wsLiveClientId = root["lv"] ? client->id() : 0;
-          }
-
-          verboseResponse = deserializeState(root);
-        }
-        if (verboseResponse || millis() - lastInterfaceUpdate < 1900) sendDataWs(client); //update if it takes longer than 100ms until next "broadcast"
+        handleWsMessage(client, data, len);
+      } else if (info->opcode == WS_BINARY) {
+        handleSegmentPixels(data, len);
       }
     } else {
       //message is comprised of multiple frames or the frame is split into multiple packets
-      //if(info->index == 0){
-        //if (!wsFrameBuffer && len < 4096) wsFrameBuffer = new uint8_t[4096];
-      //}
-
-      //if (wsFrameBuffer && len < 4096 && info->index + info->)
-      //{
-
-      //}
+      if(info->message_opcode != WS_TEXT && info->message_opcode != WS_BINARY) return;
+      WsClient* c = getWsClient(client->id());
+      if (!c) return;
+      if(info->index == 0){ //first packet of a frame, grow the buffer by the frame length
+        if (info->num == 0) freeWsMessage(c);
+        if (!c->msgDrop && c->msgLen + info->len <= wsMaxMessage) {
+          uint8_t* msg = (uint8_t*)realloc(c->msg, c->msgLen + info->len);
+          if (msg) c->msg = msg;
+          else c->msgDrop = true; //out of memory
+        } else {
+          c->msgDrop = true;
+        }
+      }
+      if (!c->msgDrop) memcpy(c->msg + c->msgLen + info->index, data, len);
 
-      if((info->index + len) == info->len){
+      if((info->index + len) == info->len){ //frame complete
+        c->msgLen += info->len;
         if(info->final){
-          if(info->message_opcode == WS_TEXT) {
-            client->text(F("{\"error\":9}")); //we do not handle split packets right now
-          }
+          if (c->msgDrop) client->text(F("{\"error\":9}")); //too large
+          else if (info->message_opcode == WS_BINARY) handleSegmentPixels(c->msg, c->msgLen);
+          else handleWsMessage(client, c->msg, c->msgLen);
+          freeWsMessage(c);
         }
       }
     }
@@ -71,40 +182,322 @@ void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventTyp
   }
 }
 
+static AsyncWebSocketMessageBuffer* makeFullBuffer()
+{
+  AsyncWebSocketMessageBuffer * buffer = nullptr;
+  JsonStream stream(3); //state from the shared snapshot, info serialized on its own
+  size_t fullLen = stream.collect([&buffer](size_t len) -> char* {
+    buffer = ws.makeBuffer(len);
+    return buffer ? (char *)buffer->get() : nullptr;
+  });
+  if (buffer) wsFullLen = fullLen;
+  return buffer;
+}
+
+//parses the part of a serialized state before the segments
+static bool parseStateHead(const char* json, JsonDocument& doc)
+{
+  const char* seg = strstr_P(json, PSTR(",\"seg\":["));
+  size_t len = seg ? seg - json : strlen(json) -1;
+  char* head = (char*)malloc(len +2);
+  if (!head) return false;
+  memcpy(head, json, len);
+  head[len] = '}'; head[len +1] = 0;
+  DeserializationError error = deserializeJson(doc, (const char*)head);
+  free(head);
+  return !error;
+}
+
+//finds the objects of the segment array in a serialized state
+static byte splitSegments(const char* json, const char** segs, uint16_t* lens, byte* ids)
+{
+  const char* p = strstr_P(json, PSTR(",\"seg\":["));
+  if (!p) return 0;
+  p += 8;
+  byte n = 0;
+  while (*p == '{' && n < MAX_NUM_SEGMENTS) {
+    const char* start = p;
+    int8_t depth = 0;
+    bool str = false;
+    do {
+      if (str) {
+        if (*p == '\\' && p[1]) p++;
+        else if (*p == '"') str = false;
+      }
+      else if (*p == '"') str = true;
+      else if (*p == '{' || *p == '[') depth++;
+      else if (*p == '}' || *p == ']') depth--;
+      p++;
+    } while (*p && depth);
+    segs[n] = start;
+    lens[n] = p - start;
+    ids[n] = atoi(start +6); //serializeSegment() writes {"id": first
+    n++;
+    if (*p == ',') p++;
+  }
+  return n;
+}
+
+//only the state fields and segments that differ from base, ver is the state after applying it
+static AsyncWebSocketMessageBuffer* makeDeltaBuffer(StateSnapshot* base, StateSnapshot* cur, size_t& len)
+{
+  AsyncWebSocketMessageBuffer * buffer = nullptr;
+  const char* baseSegs[MAX_NUM_SEGMENTS]; uint16_t baseLens[MAX_NUM_SEGMENTS]; byte baseIds[MAX_NUM_SEGMENTS];
+  const char* curSegs[MAX_NUM_SEGMENTS];  uint16_t curLens[MAX_NUM_SEGMENTS];  byte curIds[MAX_NUM_SEGMENTS];
+  byte nBase = splitSegments(base->json, baseSegs, baseLens, baseIds);
+  byte nCur  = splitSegments(cur->json, curSegs, curLens, curIds);
+
+  DynamicJsonDocument baseHead(JSON_STREAM_SEG_SIZE), curHead(JSON_STREAM_SEG_SIZE);
+  if (!parseStateHead(base->json, baseHead) || !parseStateHead(cur->json, curHead)) return nullptr;
+
+  DynamicJsonDocument doc(JSON_STREAM_SEG_SIZE);
+  JsonObject state = doc.createNestedObject("state");
+  for (JsonPair kv : curHead.as<JsonObject>()) {
+    JsonVariantConst old = baseHead[kv.key()];
+    if (old != kv.value()) state[kv.key()] = kv.value();
+  }
+  for (JsonPair kv : baseHead.as<JsonObject>()) {
+    if (!curHead.containsKey(kv.key())) state[kv.key()] = nullptr; //removed, e.g. error
+  }
+
+  JsonArray segs = state.createNestedArray("seg");
+  for (byte i = 0; i < nCur; i++) {
+    byte b = 0;
+    while (b < nBase && baseIds[b] != curIds[i]) b++;
+    if (b < nBase && baseLens[b] == curLens[i] && !memcmp(baseSegs[b], curSegs[i], curLens[i])) continue;
+    segs.add(serialized(curSegs[i], curLens[i]));
+  }
+  for (byte b = 0; b < nBase; b++) {
+    byte i = 0;
+    while (i < nCur && curIds[i] != baseIds[b]) i++;
+    if (i < nCur) continue;
+    JsonObject removed = segs.createNestedObject(); //deleted segment
+    removed["id"] = baseIds[b];
+    removed["stop"] = 0;
+  }
+  if (!segs.size()) state.remove("seg");
+
+  char ver[9];
+  sprintf_P(ver, PSTR("%08x"), cur->etag);
+  doc[F("ver")] = ver;
+  sprintf_P(ver, PSTR("%08x"), base->etag);
+  doc[F("base")] = ver;
+  if (doc.overflowed()) return nullptr; //the caller sends the full state instead
+
+  len = measureJson(doc);
+  buffer = ws.makeBuffer(len);
+  if (!buffer) return nullptr; //out of memory
+  serializeJson(doc, (char *)buffer->get(), len +1);
+  return buffer;
+}
+
 void sendDataWs(AsyncWebSocketClient * client)
 {
   if (!ws.count()) return;
+  AsyncWebSocketMessageBuffer * full = nullptr;
+  std::shared_ptr<StateSnapshot> state = getStateSnapshot();
+
+  byte tracked = 0, deltaClients = 0;
+  for (byte i = 0; i < WS_MAX_CLIENTS; i++) {
+    if (!wsClients[i].id) continue;
+    tracked++;
+    if (wsClients[i].delta) deltaClients++;
+  }
+  //everyone gets the full state unless there are delta clients and all clients are known
+  bool known = client ? getWsClient(client->id()) != nullptr : tracked >= ws.count();
+  if (!state || !deltaClients || !known) {
+    full = makeFullBuffer();
+    if (!full) return; //out of memory
+    if (client) client->text(full);
+    else        ws.textAll(full);
+    for (byte i = 0; i < WS_MAX_CLIENTS; i++) {
+      WsClient& c = wsClients[i];
+      if (c.delta && (!client || c.id == client->id())) c.base = c.sent = state;
+    }
+    return;
+  }
+
+  for (byte i = 0; i < WS_MAX_CLIENTS; i++) {
+    WsClient& c = wsClients[i];
+    if (!c.id || (client && c.id != client->id())) continue;
+    AsyncWebSocketClient * wsc = client ? client : ws.client(c.id);
+    if (!wsc) continue;
+    if (!c.delta || !c.base) {
+      if (!full) full = makeFullBuffer();
+      if (!full) return; //out of memory
+      wsc->text(full);
+      if (c.delta) c.base = c.sent = state;
+      continue;
+    }
+    if (c.sent == state) { //nothing changed since the last message
+      c.saved += wsFullLen;
+      continue;
+    }
+    size_t len = 0;
+    AsyncWebSocketMessageBuffer * delta = makeDeltaBuffer(c.base.get(), state.get(), len);
+    if (!delta) { //too large for a delta (or out of memory), start over from the full state
+      if (!full) full = makeFullBuffer();
+      if (!full) return;
+      wsc->text(full);
+      c.base = c.sent = state;
+      continue;
+    }
+    wsc->text(delta);
+    c.sent = state;
+    if (!wsFullLen) continue; //the statistic starts with the first full message, there is nothing to compare with before
+    c.deltas++;
+    c.bytes += len;
+    if (wsFullLen > len) c.saved += wsFullLen - len;
+  }
+}
+
+void serializeWsClients(JsonArray clients)
+{
+  for (byte i = 0; i < WS_MAX_CLIENTS; i++) {
+    WsClient& c = wsClients[i];
+    if (!c.delta) continue;
+    JsonObject o = clients.createNestedObject();
+    o["id"] = c.id;
+    o["n"] = c.deltas;
+    o[F("sent")] = c.bytes;
+    o[F("saved")] = c.saved;
+  }
+}
+
+//streams realtime ingest stats once per second while a client is subscribed with {"rt":true}
+void sendRealtimeStatsWs()
+{
+  AsyncWebSocketClient * wsc = ws.client(wsRtClientId);
+  if (!wsc) { wsRtClientId = 0; return; }
+  if (wsc->queueLength() > 0) return;
   AsyncWebSocketMessageBuffer * buffer;
 
   { //scope JsonDocument so it releases its buffer
-    DynamicJsonDocument doc(JSON_BUFFER_SIZE);
-    JsonObject state = doc.createNestedObject("state");
-    serializeState(state);
-    JsonObject info  = doc.createNestedObject("info");
-    serializeInfo(info);
+    DynamicJsonDocument doc(WS_RT_JSON_SIZE);
+    JsonObject rt = doc.createNestedObject("rt");
+    serializeRealtimeStats(rt);
+    if (doc.overflowed()) return; //never send incomplete stats
     size_t len = measureJson(doc);
     buffer = ws.makeBuffer(len);
     if (!buffer) return; //out of memory
 
     serializeJson(doc, (char *)buffer->get(), len +1);
-  } 
-  if (client) {
-    client->text(buffer);
-  } else {
-    ws.textAll(buffer);
+  }
+  wsc->text(buffer);
+}
+
+//binary live view, one message per chunk of up to WS_LIVE_CHUNK_LEDS LEDs
+//0: 1 (version), 1: flags (0x01 averaged), 2-3: frame id, 4-5: LEDs in the frame, 6-7: first LED of this chunk,
+//8-9: strip LEDs averaged into each LED, 10-: RGB
+static bool serveLiveLedsBinary(uint32_t wsClient)
+{
+  AsyncWebSocketClient * wsc = ws.client(wsClient);
+  if (!wsc || wsc->queueLength() > 0) return false; //only send if queue free
+  if (strip.getLastShow() == wsLiveLastShow) return true; //nothing new to show
+  wsLiveLastShow = strip.getLastShow();
+
+  uint16_t used = ledCount;
+  uint16_t maxLeds = WS_LIVE_CHUNK_LEDS * WS_LIVE_MAX_CHUNKS;
+  if (wsLiveMaxLeds && wsLiveMaxLeds < maxLeds) maxLeds = wsLiveMaxLeds;
+  uint16_t n = (used -1) / maxLeds +1; //average n LEDs if there are more than maxLeds
+  uint16_t count = (used + n -1) / n;
+  wsLiveFrame++;
+
+  for (uint16_t start = 0; start < count; start += WS_LIVE_CHUNK_LEDS) {
+    uint16_t len = count - start;
+    if (len > WS_LIVE_CHUNK_LEDS) len = WS_LIVE_CHUNK_LEDS;
+    AsyncWebSocketMessageBuffer * buffer = ws.makeBuffer(WS_LIVE_HEADER_LEN + len*3);
+    if (!buffer) return false; //out of memory
+    uint8_t* p = buffer->get();
+    p[0] = 1;
+    p[1] = (n > 1) ? 0x01 : 0;
+    p[2] = wsLiveFrame >> 8; p[3] = wsLiveFrame & 0xFF;
+    p[4] = count >> 8;       p[5] = count & 0xFF;
+    p[6] = start >> 8;       p[7] = start & 0xFF;
+    p[8] = n >> 8;           p[9] = n & 0xFF;
+    p += WS_LIVE_HEADER_LEN;
+    for (uint16_t k = start; k < start + len; k++) {
+      uint32_t first = (uint32_t)k * n, last = first + n;
+      if (last > used) last = used;
+      uint32_t r = 0, g = 0, b = 0;
+      for (uint32_t i = first; i < last; i++) {
+        uint32_t c = liveViewColor(strip.getPixelColor(i));
+        r += (c >> 16) & 0xFF; g += (c >> 8) & 0xFF; b += c & 0xFF;
+      }
+      uint16_t cnt = last - first;
+      *p++ = r / cnt; *p++ = g / cnt; *p++ = b / cnt;
+    }
+    wsc->binary(buffer);
+  }
+  return true;
+}
+
+//applies what the web server task requested, only loop() assigns the states of a client
+static void handleWsRequests()
+{
+  bool sendTo[WS_MAX_CLIENTS];
+  NET_LOCK();
+  bool all = wsSendAll;
+  wsSendAll = false;
+  NET_UNLOCK();
+
+  for (byte i = 0; i < WS_MAX_CLIENTS; i++) {
+    WsClient& c = wsClients[i];
+    NET_LOCK();
+    uint32_t id = c.id, ack = c.ack;
+    bool restart = c.restart;
+    sendTo[i] = c.send || restart;
+    c.restart = c.send = false;
+    c.ack = 0;
+    NET_UNLOCK();
+    if (!id) { //disconnected, free the slot
+      if (!c.delta) continue;
+      c.base = c.sent = nullptr;
+      c.deltas = c.bytes = c.saved = 0;
+      NET_LOCK();
+      c.delta = false;
+      NET_UNLOCK();
+      continue;
+    }
+    if (restart) {
+      c.delta = true;
+      c.base = nullptr;
+    }
+    if (ack && c.sent && ack == c.sent->etag) c.base = c.sent;
+  }
+
+  if (all) { //includes the clients below
+    sendDataWs();
+    return;
+  }
+  for (byte i = 0; i < WS_MAX_CLIENTS; i++) {
+    if (!sendTo[i] || !wsClients[i].id) continue;
+    AsyncWebSocketClient * wsc = ws.client(wsClients[i].id);
+    if (wsc) sendDataWs(wsc);
   }
 }
 
 void handleWs()
 {
-  if (millis() - wsLastLiveTime > WS_LIVE_INTERVAL)
+  handleWsRequests();
+
+  if (wsRtClientId && millis() - wsLastRtTime > WS_RT_INTERVAL)
+  {
+    sendRealtimeStatsWs();
+    wsLastRtTime = millis();
+  }
+
+  if (millis() - wsLastLiveTime > wsLiveInterval)
   {
     ws.cleanupClients();
-    bool success = true;
-    if (wsLiveClientId)
-      success = serveLiveLeds(nullptr, wsLiveClientId);
+    if (wsLiveClientId) {
+      bool success = wsLiveBinary ? serveLiveLedsBinary(wsLiveClientId) : serveLiveLeds(nullptr, wsLiveClientId);
+      //adapt the rate to the client, back off while its queue is not empty
+      if (!success) wsLiveInterval += WS_LIVE_INTERVAL/2;
+      else          wsLiveInterval -= wsLiveInterval/8;
+      wsLiveInterval = constrain(wsLiveInterval, WS_LIVE_INTERVAL, WS_LIVE_MAX_INTERVAL);
+    }
     wsLastLiveTime = millis();
-    if (!success) wsLastLiveTime -= 20; //try again in 20ms if failed due to non-empty WS queue
   }
 }
 